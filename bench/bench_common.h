@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "transport_catalogue/transport_catalogue.h"
+
+namespace transport_catalogue::bench {
+
+    // Лучшее время из repeat запусков func, в миллисекундах
+    template <typename Func>
+    double MeasureMs(int repeat, Func func) {
+        double best = 0.0;
+        for (int i = 0; i < repeat; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            func();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    // Названия синтетического каталога, каталог ссылается на них, пока заполняется
+    struct SyntheticNames {
+        std::vector<std::string> stops;
+        std::vector<std::string> buses;
+    };
+
+    /*
+     * Заполняет пустой каталог stop_count остановками в границах Москвы и bus_count автобусами.
+     * Маршрут - случайное блуждание по соседним номерам остановок, расстояния заданы для каждого перегона
+     */
+    inline SyntheticNames FillSyntheticCatalogue(TransportCatalogue& db, size_t stop_count, size_t bus_count,
+                                                 size_t route_size = 30, unsigned seed = 42) {
+        std::mt19937 random(seed);
+        SyntheticNames names;
+        names.stops.reserve(stop_count);
+        for (size_t i = 0; i < stop_count; ++i) {
+            names.stops.push_back("Stop " + std::to_string(i));
+        }
+        names.buses.reserve(bus_count);
+        for (size_t i = 0; i < bus_count; ++i) {
+            names.buses.push_back("Bus " + std::to_string(i));
+        }
+
+        std::uniform_real_distribution<double> latitude(55.57, 55.91);
+        std::uniform_real_distribution<double> longitude(37.37, 37.84);
+        std::vector<StopDescription> stops;
+        stops.reserve(stop_count);
+        for (const std::string& name : names.stops) {
+            stops.push_back({name, {latitude(random), longitude(random)}});
+        }
+
+        std::uniform_int_distribution<int> step(-10, 10);
+        std::uniform_int_distribution<int> length(200, 3000);
+        std::vector<DistanceDescription> distances;
+        std::vector<BusDescription> buses(bus_count);
+        for (size_t bus = 0; bus < bus_count; ++bus) {
+            buses[bus].name = names.buses[bus];
+            buses[bus].type = bus % 2 == 0 ? RouteType::ONE_WAY : RouteType::ROUND_TRIP;
+            long stop = static_cast<long>(random() % stop_count);
+            for (size_t i = 0; i < route_size; ++i) {
+                buses[bus].stops.push_back(names.stops[stop]);
+                const long next = std::clamp<long>(stop + step(random), 0, static_cast<long>(stop_count) - 1);
+                if (i + 1 < route_size) {
+                    distances.push_back({names.stops[stop], names.stops[next], length(random)});
+                }
+                stop = next;
+            }
+        }
+
+        db.AddBulk(stops, distances, buses);
+        db.Finalize();
+        return names;
+    }
+
+} // namespace transport_catalogue::bench
@@ -0,0 +1,130 @@
+#include "bench_common.h"
+
+#include "service/json_reader/json_reader.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+    // Таблица расстояний до DistanceTable: ключ - пара указателей на остановки, слабый хэш,
+    // поиск через count() и at()
+    struct Stop {
+        StopId id;
+    };
+
+    struct StopsHasher {
+        size_t operator()(const pair<const Stop*, const Stop*>& stops) const {
+            return ptr_hasher(stops.first) + ptr_hasher(stops.second) * 37;
+        }
+
+        hash<const void*> ptr_hasher;
+    };
+
+    class PairMapDistances {
+    public:
+        explicit PairMapDistances(const TransportCatalogue& db)
+            : stops_(db.GetStopCount()) {
+            for (StopId stop = 0; stop < stops_.size(); ++stop) {
+                stops_[stop].id = stop;
+            }
+            for (const auto& [stops, length] : db.GetDistances()) {
+                stops_to_length_[{&stops_[stops.first], &stops_[stops.second]}] = length;
+            }
+        }
+
+        int GetRealLength(StopId first_stop, StopId second_stop) const {
+            const pair<const Stop*, const Stop*> first_to_second = {&stops_[first_stop], &stops_[second_stop]};
+            if (stops_to_length_.count(first_to_second) > 0) {
+                return stops_to_length_.at(first_to_second);
+            }
+            return 0;
+        }
+
+    private:
+        vector<Stop> stops_;
+        unordered_map<pair<const Stop*, const Stop*>, int, StopsHasher> stops_to_length_;
+    };
+
+    // Пары остановок, которые спрашивает подсчёт статистики маршрутов: перегоны в обе стороны
+    vector<pair<StopId, StopId>> CollectRouteLegs(const TransportCatalogue& db) {
+        vector<pair<StopId, StopId>> legs;
+        for (BusId bus = 0; bus < db.GetBusCount(); ++bus) {
+            const RouteRange route = db.GetBusRoute(bus);
+            for (size_t i = 1; i < route.size(); ++i) {
+                legs.emplace_back(route[i - 1], route[i]);
+                legs.emplace_back(route[i], route[i - 1]);
+            }
+        }
+        return legs;
+    }
+
+    void Run(string_view name, const TransportCatalogue& db) {
+        constexpr size_t LOOKUPS = 20'000'000;
+        constexpr int REPEAT = 3;
+
+        const vector<pair<StopId, StopId>> legs = CollectRouteLegs(db);
+        const PairMapDistances pair_map(db);
+        auto measure = [&legs](auto get_length) {
+            long long checksum = 0;
+            const double ms = bench::MeasureMs(REPEAT, [&] {
+                checksum = 0;
+                for (size_t i = 0; i < LOOKUPS; ++i) {
+                    const auto& [from, to] = legs[i % legs.size()];
+                    checksum += get_length(from, to);
+                }
+            });
+            return make_pair(LOOKUPS / ms / 1000.0, checksum);
+        };
+        const auto [before, before_checksum] = measure([&pair_map](StopId from, StopId to) {
+            return pair_map.GetRealLength(from, to);
+        });
+        const auto [after, after_checksum] = measure([&db](StopId from, StopId to) {
+            return db.GetRealLength(from, to);
+        });
+
+        cout << name << ": "sv << db.GetStopCount() << " stops, "sv << db.GetDistances().size() << " distances, "sv
+             << legs.size() << " route legs\n"sv
+             << "  pair map, count + at: "sv << before << " M lookups/s\n"sv
+             << "  DistanceTable:        "sv << after << " M lookups/s\n"sv;
+        if (before_checksum != after_checksum) {
+            cout << "  checksums differ!\n"sv;
+        }
+    }
+
+} // namespace
+
+/*
+ * Пропускная способность GetRealLength: прежняя таблица на unordered_map против DistanceTable.
+ * Usage: distance_bench [input.json]
+ * Второй каталог - синтетический, в 100 раз больше первого по числу остановок и автобусов
+ */
+int main(int argc, char* argv[]) {
+    CataloguePublisher publisher;
+    service::JsonReader json_reader(publisher);
+    bench::SyntheticNames small_names;
+    if (argc > 1) {
+        json_reader.ReadJsonFile(argv[1]);
+        json_reader.FillCatalogue(false);
+    } else {
+        CatalogueBuilder builder;
+        small_names = bench::FillSyntheticCatalogue(builder.GetCatalogue(), 100, 100);
+        publisher.Publish(builder.Build());
+    }
+    const CatalogueSnapshot small_snapshot = publisher.Pin();
+    const TransportCatalogue& small_db = *small_snapshot;
+    Run(argc > 1 ? argv[1] : "synthetic"sv, small_db);
+
+    TransportCatalogue big_db;
+    const bench::SyntheticNames big_names = bench::FillSyntheticCatalogue(
+            big_db, small_db.GetStopCount() * 100, small_db.GetBusCount() * 100);
+    Run("synthetic x100"sv, big_db);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "bench_common.h"
+
+#include "geo/geo.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace transport_catalogue;
+
+/*
+ * Расстояния по исходным координатам против расстояний по заранее посчитанным синусам и косинусам
+ * широт, поштучно и пакетом. Заодно сверяет результаты с ComputeDistance(Coordinates).
+ * Usage: geo_bench [pair_count]
+ */
+int main(int argc, char* argv[]) {
+    constexpr int REPEAT = 5;
+    const size_t count = argc > 1 ? stoul(argv[1]) : 1'000'000;
+
+    //Половина пар - соседние остановки в пределах ~100 м, на них acos чувствительнее всего к погрешности
+    mt19937 random(42);
+    uniform_real_distribution<double> latitude(55.57, 55.91);
+    uniform_real_distribution<double> longitude(37.37, 37.84);
+    uniform_real_distribution<double> near(-0.001, 0.001);
+    vector<geo::Coordinates> from(count);
+    vector<geo::Coordinates> to(count);
+    for (size_t i = 0; i < count; ++i) {
+        from[i] = {latitude(random), longitude(random)};
+        to[i] = i % 2 == 0 ? geo::Coordinates{from[i].lat + near(random), from[i].lng + near(random)}
+                           : geo::Coordinates{latitude(random), longitude(random)};
+    }
+    vector<geo::SphericalCoordinates> from_spherical(count);
+    vector<geo::SphericalCoordinates> to_spherical(count);
+    for (size_t i = 0; i < count; ++i) {
+        from_spherical[i] = geo::ToSpherical(from[i]);
+        to_spherical[i] = geo::ToSpherical(to[i]);
+    }
+
+    vector<double> expected(count);
+    vector<double> single(count);
+    vector<double> batch(count);
+    const double coords_ms = bench::MeasureMs(REPEAT, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            expected[i] = geo::ComputeDistance(from[i], to[i]);
+        }
+    });
+    const double single_ms = bench::MeasureMs(REPEAT, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            single[i] = geo::ComputeDistance(from_spherical[i], to_spherical[i]);
+        }
+    });
+    const double batch_ms = bench::MeasureMs(REPEAT, [&] {
+        geo::ComputeDistances(from_spherical.data(), to_spherical.data(), batch.data(), count);
+    });
+
+    size_t bit_differences = 0;
+    double max_relative_error = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        for (const double value : {single[i], batch[i]}) {
+            if (memcmp(&value, &expected[i], sizeof(double)) != 0) {
+                ++bit_differences;
+            }
+            if (expected[i] != 0.0) {
+                max_relative_error = max(max_relative_error, abs(value - expected[i]) / expected[i]);
+            }
+        }
+    }
+
+    auto per_pair = [count](double ms) {
+        return ms * 1e6 / static_cast<double>(count);
+    };
+    cout << count << " pairs\n"sv
+         << "ComputeDistance(Coordinates):          "sv << per_pair(coords_ms) << " ns/pair\n"sv
+         << "ComputeDistance(SphericalCoordinates): "sv << per_pair(single_ms) << " ns/pair\n"sv
+         << "ComputeDistances:                      "sv << per_pair(batch_ms) << " ns/pair\n"sv
+         << "bit differences: "sv << bit_differences << ", max relative error: "sv << max_relative_error << '\n';
+    return max_relative_error <= 1e-9 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include "bench_common.h"
+
+#include "service/json_reader/json_reader.h"
+#include "service/serialization/serialization.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+#include "transport_catalogue/flat_catalogue.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+using namespace std;
+using namespace transport_catalogue;
+
+/*
+ * Загрузка базы из protobuf против отображения плоского формата.
+ * Usage: loader_bench [input.json | stop_count]
+ * Без аргументов - синтетический каталог из 20000 остановок и 2000 автобусов
+ */
+int main(int argc, char* argv[]) {
+    constexpr int REPEAT = 5;
+
+    CataloguePublisher publisher;
+    service::JsonReader json_reader(publisher);
+    bench::SyntheticNames names;
+    const string_view arg = argc > 1 ? argv[1] : "20000"sv;
+    if (!arg.empty() && isdigit(static_cast<unsigned char>(arg.front()))) {
+        const size_t stop_count = stoul(string(arg));
+        CatalogueBuilder builder;
+        names = bench::FillSyntheticCatalogue(builder.GetCatalogue(), stop_count, stop_count / 10);
+        publisher.Publish(builder.Build());
+    } else {
+        json_reader.ReadJsonFile(string(arg));
+        json_reader.FillCatalogue(false);
+    }
+    const CatalogueSnapshot snapshot = publisher.Pin();
+    const TransportCatalogue& db = *snapshot;
+
+    //Карта в базе нужна, чтобы protobuf разбирал столько же, сколько в настоящей базе
+    service::RenderSettings render_settings;
+    render_settings.width = 1200;
+    render_settings.height = 1200;
+    render_settings.padding = 50;
+    render_settings.line_width = 14;
+    render_settings.stop_radius = 5;
+    render_settings.color_palette = {"green"s, svg::Rgb{255, 160, 0}, "red"s};
+    const service::MapRenderer map_renderer(render_settings);
+    const service::TransportRouter transport_router(db);
+
+    const filesystem::path dir = filesystem::temp_directory_path();
+    const string proto_path = (dir / "loader_bench_base.db").string();
+    const string flat_path = (dir / "loader_bench_base.flat").string();
+    {
+        ofstream proto_out(proto_path, ios::binary);
+        service::SerializeBase(db, map_renderer, transport_router, proto_out);
+        ofstream flat_out(flat_path, ios::binary);
+        WriteFlatCatalogue(db, flat_out);
+    }
+
+    vector<string> bus_names;
+    vector<string> stop_names;
+    for (BusId bus = 0; bus < db.GetBusCount(); ++bus) {
+        bus_names.emplace_back(db.GetBusName(bus));
+    }
+    for (StopId stop = 0; stop < db.GetStopCount(); ++stop) {
+        stop_names.emplace_back(db.GetStopName(stop));
+    }
+
+    //Запросы Bus и Stop ко всему каталогу, чтобы сравнить и стоимость чтения после загрузки
+    size_t checksum = 0;
+    auto query_catalogue = [&](const auto& catalogue) {
+        for (const string& bus : bus_names) {
+            checksum += catalogue.GetRouteInfo(bus).total_stops;
+        }
+    };
+
+    const double proto_ms = bench::MeasureMs(REPEAT, [&] {
+        TransportCatalogue loaded;
+        service::MapRenderer loaded_renderer;
+        service::TransportRouter loaded_router(loaded);
+        ifstream in(proto_path, ios::binary);
+        if (!service::DeserializeBase(in, loaded, loaded_renderer, loaded_router)) {
+            cerr << "Could not load base!"sv << endl;
+            exit(1);
+        }
+        query_catalogue(loaded);
+    });
+    const double flat_ms = bench::MeasureMs(REPEAT, [&] {
+        const FlatCatalogue loaded(flat_path);
+        query_catalogue(loaded);
+    });
+
+    cout << "stops "sv << db.GetStopCount() << ", buses "sv << db.GetBusCount() << '\n'
+         << "protobuf: "sv << filesystem::file_size(proto_path) << " bytes, load + Bus queries "sv << proto_ms << " ms\n"sv
+         << "flat:     "sv << filesystem::file_size(flat_path) << " bytes, open + Bus queries "sv << flat_ms << " ms\n"sv
+         << "checksum "sv << checksum << endl;
+
+    filesystem::remove(proto_path);
+    filesystem::remove(flat_path);
+    return 0;
+}
@@ -5,6 +5,13 @@
 
 namespace geo {
 
+    namespace {
+
+        constexpr double DR = M_PI / 180.;
+        constexpr double EARTH_RADIUS = 6371000;
+
+    } // namespace
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         const double dr = M_PI / 180.;
@@ -13,4 +20,21 @@ namespace geo {
                * 6371000;
     }
 
+    SphericalCoordinates ToSpherical(Coordinates point) {
+        return {std::sin(point.lat * DR), std::cos(point.lat * DR), point.lng};
+    }
+
+    double ComputeDistance(const SphericalCoordinates& from, const SphericalCoordinates& to) {
+        using namespace std;
+        return acos(from.sin_lat * to.sin_lat + from.cos_lat * to.cos_lat * cos(abs(from.lng - to.lng) * DR))
+               * EARTH_RADIUS;
+    }
+
+    void ComputeDistances(const SphericalCoordinates* from, const SphericalCoordinates* to,
+                          double* distances, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            distances[i] = ComputeDistance(from[i], to[i]);
+        }
+    }
+
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace geo {
 
     struct Coordinates {
@@ -7,6 +9,23 @@ namespace geo {
         double lng = 0.0;
     };
 
+    // Точка с заранее посчитанными синусом и косинусом широты. Долгота остаётся в градусах,
+    // чтобы разность долгот считалась так же, как в ComputeDistance(Coordinates, Coordinates)
+    struct SphericalCoordinates {
+        double sin_lat = 0.0;
+        double cos_lat = 1.0;
+        double lng = 0.0;
+    };
+
     double ComputeDistance(Coordinates from, Coordinates to);
 
+    SphericalCoordinates ToSpherical(Coordinates point);
+
+    // Совпадает с ComputeDistance по исходным координатам до бита
+    double ComputeDistance(const SphericalCoordinates& from, const SphericalCoordinates& to);
+
+    // distances[i] = ComputeDistance(from[i], to[i]) для i из [0, count)
+    void ComputeDistances(const SphericalCoordinates* from, const SphericalCoordinates* to,
+                          double* distances, size_t count);
+
 } //namespace geo
@@ -1,322 +1,505 @@
 #include "json.h"
+#include "json_scanner.h"
+#include "json_writer.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iterator>
 #include <unordered_map>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace std;
 
 namespace json {
 
     namespace {
 
-        //Обработка перед выводом
-        std::string OutPrepare(std::string_view raw_str) {
-            std::string result;
-
-            static const unordered_map<char, string> pattern_to_result {
-                    {'\\', "\\\\"s},
-                    {'\"', "\\\""s},
-                    {'\n', "\\n"s},
-                    {'\r', "\\r"s},
-                    {'\t', "\\t"s},
-            };
-
-            for (const char c : raw_str) {
-                if (pattern_to_result.count(c) > 0) {
-                    result += pattern_to_result.at(c);
-                    continue;
+        // Закрывает отображение файла при выходе из области видимости
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) {
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw std::runtime_error("Could not open json file \""s + path + "\""s);
+                }
+                struct stat file_stat{};
+                if (fstat(fd, &file_stat) != 0) {
+                    close(fd);
+                    throw std::runtime_error("Could not read json file \""s + path + "\""s);
+                }
+                size_ = static_cast<size_t>(file_stat.st_size);
+                if (size_ == 0) {
+                    close(fd);
+                    return;
                 }
-                result += c;
+                void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                close(fd);
+                if (mapped == MAP_FAILED) {
+                    throw std::runtime_error("Could not map json file \""s + path + "\""s);
+                }
+                //Файл читается один раз от начала до конца
+                madvise(mapped, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(mapped);
             }
 
-            return result;
-        }
+            ~MappedFile() {
+                if (data_ != nullptr) {
+                    munmap(const_cast<char*>(data_), size_);
+                }
+            }
 
-        Node LoadNode(istream& input);
+            std::string_view GetText() const {
+                return {data_, size_};
+            }
 
-        Node LoadArray(istream& input) {
-            Array result;
-            char c;
-            bool first = true;
-            while (input >> c && c != ']') {
-                if (first) {
-                    input.putback(c);
-                } else {
-                    if (c != ',') {
-                        throw ParsingError("Failed attempt to parse Array! There is no comma between items"s);
-                    }
+            // Возвращает системе целые страницы до offset. Отображение только для чтения,
+            // поэтому при повторном обращении страница просто перечитается из файла
+            void Release(size_t offset) {
+                static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+                const size_t end = offset / page_size * page_size;
+                if (end > released_) {
+                    madvise(const_cast<char*>(data_) + released_, end - released_, MADV_DONTNEED);
+                    released_ = end;
                 }
-                first = false;
-                result.push_back(LoadNode(input));
-            }
-            if (!input) {
-                throw ParsingError("Failed attempt to parse Array! There is no end bracket"s);
             }
-            return Node(move(result));
-        }
 
-        Node LoadNumber(std::istream& input) {
-            using namespace std::literals;
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
 
-            std::string parsed_num;
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+            size_t released_ = 0;
+        };
 
-            // Считывает в parsed_num очередной символ из input
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
-                }
-            };
+        //Второй проход разбора. Пробелы не просматриваются: следующий токен берётся из индекса первого прохода,
+        //а указатель на текст сдвигается только внутри чисел и литералов. Значения передаются обработчику
+        template <typename Handler>
+        class Parser {
+        public:
+            Parser(std::string_view text, Handler& handler, MappedFile* file = nullptr)
+                : data_(text.data())
+                , pos_(text.data())
+                , end_(text.data() + text.size())
+                , scanner_(text)
+                , handler_(handler)
+                , file_(file) {
+            }
 
-            // Считывает одну или более цифр в parsed_num из input
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
+            void ParseValue() {
+                //В конце текста ждём число, как ждал его Load по istream
+                char c;
+                if (!PeekToken(c)) {
                     throw ParsingError("A digit is expected"s);
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                if (c == '[') {
+                    ConsumeToken();
+                    ParseArray();
+                    return;
+                } else if (c == '{') {
+                    ConsumeToken();
+                    ParseDict();
+                    return;
+                } else if (c == '"') {
+                    ConsumeToken();
+                    handler_.OnString(ParseString());
+                    return;
                 }
-            };
 
-            if (input.peek() == '-') {
-                read_char();
+                DropToken();
+                if (c == 't' || c == 'f') {
+                    handler_.OnBool(ParseBool());
+                } else if (c == 'n') {
+                    ParseNull();
+                    handler_.OnNull();
+                } else {
+                    ParseNumber();
+                }
+                AfterScalar();
             }
-            // Парсим целую часть числа
-            if (input.peek() == '0') {
-                read_char();
-                // После 0 в JSON не могут идти другие цифры
-            } else {
-                read_digits();
+
+        private:
+            const char* data_;
+            const char* pos_;
+            const char* end_;
+            StructuralScanner scanner_;
+            // Индекс текущего участка текста
+            std::vector<uint32_t> index_;
+            const uint32_t* next_ = nullptr;
+            const uint32_t* index_end_ = nullptr;
+            Handler& handler_;
+            MappedFile* file_;
+            // Скаляр закончился на символе, которого нет в индексе. Он и будет следующим токеном, как и раньше
+            bool pending_ = false;
+            // Строка с escape-последовательностями, раскодированная для обработчика
+            std::string scratch_;
+
+            static bool IsSpace(char c) {
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+            }
+
+            static bool IsDigit(char c) {
+                return c >= '0' && c <= '9';
+            }
+
+            static bool IsAlpha(char c) {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
             }
 
-            bool is_int = true;
-            // Парсим дробную часть числа
-            if (input.peek() == '.') {
-                read_char();
-                read_digits();
-                is_int = false;
+            int Peek() const {
+                return pos_ < end_ ? static_cast<unsigned char>(*pos_) : EOF;
             }
 
-            // Парсим экспоненциальную часть числа
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+            // Подгружает индекс следующего участка, если текущий исчерпан. Возвращает false в конце текста
+            bool HasIndex() {
+                while (next_ == index_end_) {
+                    if (file_ != nullptr) {
+                        file_->Release(static_cast<size_t>(pos_ - data_));
+                    }
+                    if (!scanner_.ScanNext(index_)) {
+                        return false;
+                    }
+                    next_ = index_.data();
+                    index_end_ = next_ + index_.size();
                 }
-                read_digits();
-                is_int = false;
+                return true;
             }
 
-            try {
-                if (is_int) {
-                    // Сначала пробуем преобразовать строку в int
-                    try {
-                        return Node(std::stoi(parsed_num));
-                    } catch (...) {
-                        // В случае неудачи, например, при переполнении
-                        // код ниже попробует преобразовать строку в double
+            // Встаёт на следующий токен, не забирая его. Возвращает false, если токены кончились
+            bool PeekToken(char& c) {
+                if (!pending_) {
+                    if (!HasIndex()) {
+                        return false;
                     }
+                    pos_ = data_ + *next_;
                 }
-                return Node(std::stod(parsed_num));
-            } catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+                c = *pos_;
+                return true;
             }
-        }
 
-        string ReadChars(istream& input) {
-            string result;
-            while (isalpha(input.peek())) {
-                result += static_cast<char>(input.get());
+            // Забирает токен, на котором стоит pos_, оставаясь на нём
+            void DropToken() {
+                if (pending_) {
+                    pending_ = false;
+                } else {
+                    ++next_;
+                }
             }
-            return result;
-        }
 
-        Node LoadBool(istream& input) {
-            string str_value = ReadChars(input);
-            if (str_value != "true"sv && str_value != "false"sv) {
-                throw ParsingError("Failed attempt to parse \""s + str_value + "\" as bool!"s);
+            // Забирает токен и встаёт за ним
+            void ConsumeToken() {
+                DropToken();
+                ++pos_;
             }
-            return Node(str_value == "true"sv);
-        }
 
-        Node LoadNull(istream& input) {
-            string str_value = ReadChars(input);
-            if (str_value != "null"sv) {
-                throw ParsingError("Failed attempt to parse \""s + str_value + "\" as null!"s);
+            bool TryNextToken(char& c) {
+                if (!PeekToken(c)) {
+                    return false;
+                }
+                ConsumeToken();
+                return true;
             }
-            return Node();
-        }
 
-        Node LoadString(istream& input) {
-            string line;
-
-            //new_seq - флаг, обозначающий, что началась последовательность управляющего символа
-            bool new_seq = false;
-            for (char c = input.get(); input; c = input.get()) {
-
-                //сначала нужно проверить, нет ли у нас открытого начала последовательности
-                if (new_seq) {
-                    //если есть, то следующим символом должен быть один из списка
-                    static const std::unordered_map<char, char> pattern_to_char {
-                            {'\\', '\\'},
-                            {'"', '\"'},
-                            {'n', '\n'},
-                            {'r', '\r'},
-                            {'t', '\t'},
-                    };
-
-                    //если идёт какай-то другой символ, кидаем исключение
-                    if (pattern_to_char.count(c) == 0) {
-                        throw ParsingError("Failed attempt to parse string! Invalid escape sequence: \'\\"s + c + '\'');
+            void AfterScalar() {
+                pending_ = pos_ < end_ && !IsSpace(*pos_) && (!HasIndex() || data_ + *next_ != pos_);
+            }
+
+            void ParseArray() {
+                handler_.OnStartArray();
+                char c = 0;
+                bool first = true;
+                while (PeekToken(c) && c != ']') {
+                    if (!first) {
+                        if (c != ',') {
+                            throw ParsingError("Failed attempt to parse Array! There is no comma between items"s);
+                        }
+                        ConsumeToken();
                     }
+                    first = false;
+                    ParseValue();
+                }
+                if (c != ']') {
+                    throw ParsingError("Failed attempt to parse Array! There is no end bracket"s);
+                }
+                ConsumeToken();
+                handler_.OnEndArray();
+            }
+
+            void ParseNumber() {
+                const char* begin = pos_;
 
-                    //в строку вставляем сразу нужный управляющий символ
-                    line += pattern_to_char.at(c);
+                // Считывает одну или более цифр
+                auto read_digits = [this] {
+                    if (!IsDigit(static_cast<char>(Peek()))) {
+                        throw ParsingError("A digit is expected"s);
+                    }
+                    while (pos_ < end_ && IsDigit(*pos_)) {
+                        ++pos_;
+                    }
+                };
 
-                    new_seq = false;
-                    continue;
+                if (Peek() == '-') {
+                    ++pos_;
+                }
+                // Парсим целую часть числа
+                if (Peek() == '0') {
+                    ++pos_;
+                    // После 0 в JSON не могут идти другие цифры
+                } else {
+                    read_digits();
                 }
 
-                //если открытой последовательности у нас нет, нужно проверить, не начинается ли она
-                if (c == '\\') {
-                    new_seq = true;
-                    continue;
+                bool is_int = true;
+                // Парсим дробную часть числа
+                if (Peek() == '.') {
+                    ++pos_;
+                    read_digits();
+                    is_int = false;
                 }
 
-                //если открытой последовательности нет и текущий сивол - ", значит, парсинг строки завершён
-                if (c == '"') {
-                    break;
+                // Парсим экспоненциальную часть числа
+                if (int ch = Peek(); ch == 'e' || ch == 'E') {
+                    ++pos_;
+                    if (ch = Peek(); ch == '+' || ch == '-') {
+                        ++pos_;
+                    }
+                    read_digits();
+                    is_int = false;
                 }
 
-                if (c == '\n' || c == '\r') {
-                    throw ParsingError("Unexpected end of line"s);
+                //Число разбирается прямо в тексте. Не поместившееся в int целое читается как double
+                if (is_int) {
+                    int value;
+                    if (const auto [end, error] = std::from_chars(begin, pos_, value); error == std::errc()) {
+                        handler_.OnInt(value);
+                        return;
+                    }
+                }
+                //stod отвергал и денормализованные значения, from_chars их принимает
+                double value;
+                if (const auto [end, error] = std::from_chars(begin, pos_, value);
+                        error != std::errc() || std::fpclassify(value) == FP_SUBNORMAL) {
+                    throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
                 }
+                handler_.OnDouble(value);
+            }
 
-                line += c;
+            std::string_view ReadChars() {
+                const char* begin = pos_;
+                while (pos_ < end_ && IsAlpha(*pos_)) {
+                    ++pos_;
+                }
+                return {begin, static_cast<size_t>(pos_ - begin)};
             }
 
-            if (!input) {
-                throw ParsingError("Failed attempt to parse string! There is no end quote"s);
+            bool ParseBool() {
+                std::string_view str_value = ReadChars();
+                if (str_value != "true"sv && str_value != "false"sv) {
+                    throw ParsingError("Failed attempt to parse \""s + std::string(str_value) + "\" as bool!"s);
+                }
+                return str_value == "true"sv;
             }
 
-            return Node(move(line));
-        }
+            void ParseNull() {
+                std::string_view str_value = ReadChars();
+                if (str_value != "null"sv) {
+                    throw ParsingError("Failed attempt to parse \""s + std::string(str_value) + "\" as null!"s);
+                }
+            }
 
-        Node LoadDict(istream& input) {
-            Dict result;
-            char c;
+            //Внутри строки в индексе только начала escape-последовательностей, переводы строк и закрывающая кавычка.
+            //Строка без них отдаётся прямо из текста, иначе куски между ними копируются в scratch_
+            std::string_view ParseString() {
+                const char* run = pos_;
+                bool decoded = false;
+                while (HasIndex()) {
+                    const char* special = data_ + *next_++;
+
+                    const char c = *special;
+                    if (c == '"') {
+                        pos_ = special + 1;
+                        if (!decoded) {
+                            return {run, static_cast<size_t>(special - run)};
+                        }
+                        scratch_.append(run, special);
+                        return scratch_;
+                    }
+                    if (!decoded) {
+                        scratch_.clear();
+                        decoded = true;
+                    }
+                    scratch_.append(run, special);
+                    if (c == '\n' || c == '\r') {
+                        throw ParsingError("Unexpected end of line"s);
+                    }
 
-            bool first = true;
-            while (input >> c && c != '}') {
-                //сначала проверям на наличие запятой, если элемент не первый
-                if (!first) {
-                    if (c != ',') {
-                        throw ParsingError("Failed attempt to parse Dictionary! There is no comma between items"s);
+                    //началась последовательность управляющего символа, следующим должен быть один из списка
+                    if (special + 1 == end_) {
+                        break;
                     }
-                    input >> c;
+                    switch (const char escaped = special[1]; escaped) {
+                        case '\\': scratch_ += '\\'; break;
+                        case '"': scratch_ += '"'; break;
+                        case 'n': scratch_ += '\n'; break;
+                        case 'r': scratch_ += '\r'; break;
+                        case 't': scratch_ += '\t'; break;
+                        default:
+                            throw ParsingError("Failed attempt to parse string! Invalid escape sequence: \'\\"s + escaped + '\'');
+                    }
+                    run = special + 2;
                 }
-                first = false;
 
-                //тут проверяем на первую кавычку, чтобы убедиться, что ключом будет точно строка
-                if (c != '"') {
-                    throw ParsingError("Failed attempt to parse Dictionary! Invalid key format. A string is expected"s);
-                }
+                throw ParsingError("Failed attempt to parse string! There is no end quote"s);
+            }
 
-                string key = LoadString(input).AsString();
-                input >> c;
+            void ParseDict() {
+                handler_.OnStartDict();
+                char c = 0;
 
-                //здесь проверяем, что ключ со значением разделены двоеточием
-                if (c != ':') {
-                    throw ParsingError("Failed attempt to parse Dictionary! There is no colon between key and value"s);
-                }
+                bool first = true;
+                while (PeekToken(c) && c != '}') {
+                    ConsumeToken();
+                    //сначала проверям на наличие запятой, если элемент не первый
+                    if (!first) {
+                        if (c != ',') {
+                            throw ParsingError("Failed attempt to parse Dictionary! There is no comma between items"s);
+                        }
+                        //В конце текста c остаётся запятой, и ошибка - в формате ключа
+                        TryNextToken(c);
+                    }
+                    first = false;
+
+                    //тут проверяем на первую кавычку, чтобы убедиться, что ключом будет точно строка
+                    if (c != '"') {
+                        throw ParsingError("Failed attempt to parse Dictionary! Invalid key format. A string is expected"s);
+                    }
 
-                if (result.count(key) > 0) {
-                    throw ParsingError("Failed attempt to parse Dictionary! Duplicate key \""s
-                                       + key + "\" have been found"s);
+                    const std::string_view key = ParseString();
+
+                    //здесь проверяем, что ключ со значением разделены двоеточием
+                    if (!TryNextToken(c) || c != ':') {
+                        throw ParsingError("Failed attempt to parse Dictionary! There is no colon between key and value"s);
+                    }
+
+                    handler_.OnKey(key);
+                    ParseValue();
                 }
 
-                result.insert({move(key), LoadNode(input)});
+                if (c != '}') {
+                    throw ParsingError("Failed attempt to parse Dictionary! There is no end bracket"s);
+                }
+                ConsumeToken();
+                handler_.OnEndDict();
             }
+        };
 
-            if (!input) {
-                throw ParsingError("Failed attempt to parse Dictionary! There is no end bracket"s);
-            }
+    }  // namespace
 
-            return Node(move(result));
+    //Dict
+    Dict::Dict(std::initializer_list<value_type> items)
+        : Dict(std::vector<value_type>(items)) {
+    }
+
+    Dict::Dict(std::vector<value_type> items)
+        : items_(move(items)) {
+        auto less = [](const value_type& lhs, const value_type& rhs) {
+            return lhs.first < rhs.first;
+        };
+        //Ключи, уже идущие строго по возрастанию, не пересортировываем
+        if (std::adjacent_find(items_.begin(), items_.end(), [](const value_type& lhs, const value_type& rhs) {
+            return !(lhs.first < rhs.first);
+        }) == items_.end()) {
+            return;
         }
+        std::stable_sort(items_.begin(), items_.end(), less);
+        items_.erase(std::unique(items_.begin(), items_.end(), [](const value_type& lhs, const value_type& rhs) {
+            return lhs.first == rhs.first;
+        }), items_.end());
+    }
 
-        Node LoadNode(istream& input) {
-            char c;
-            input >> c;
+    Dict::iterator Dict::begin() {
+        return items_.begin();
+    }
 
-            if (c == '[') {
-                return LoadArray(input);
-            } else if (c == '{') {
-                return LoadDict(input);
-            } else if (c == '"') {
-                return LoadString(input);
-            }
+    Dict::iterator Dict::end() {
+        return items_.end();
+    }
 
-            input.putback(c);
-            if (c == 't' || c == 'f') {
-                return LoadBool(input);
-            } else if (c == 'n') {
-                return LoadNull(input);
-            } else {
-                return LoadNumber(input);
-            }
-        }
+    Dict::const_iterator Dict::begin() const {
+        return items_.begin();
+    }
 
-        struct DataPrinter {
-            std::ostream& out;
+    Dict::const_iterator Dict::end() const {
+        return items_.end();
+    }
 
-            void operator()(int value) {
-                out << value;
-            }
+    size_t Dict::size() const {
+        return items_.size();
+    }
 
-            void operator()(double value) {
-                out << value;
-            }
+    bool Dict::empty() const {
+        return items_.empty();
+    }
 
-            void operator()(bool value) {
-                out << std::boolalpha << value << std::noboolalpha;
-            }
+    Dict::iterator Dict::find(std::string_view key) {
+        const iterator it = LowerBound(key);
+        return it != items_.end() && it->first == key ? it : items_.end();
+    }
 
-            void operator()(const Array& array) {
-                out << '[';
-                bool first = true;
-                for (const Node& node : array) {
-                    if (!first) {
-                        out << ", "s;
-                    }
-                    first = false;
-                    out << node;
-                }
-                out << ']';
-            }
+    Dict::const_iterator Dict::find(std::string_view key) const {
+        const const_iterator it = LowerBound(key);
+        return it != items_.end() && it->first == key ? it : items_.end();
+    }
 
-            void operator()(const Dict& dict) {
-                out << '{';
-                bool first = true;
-                for (const auto& [key, node] : dict) {
-                    if (!first) {
-                        out << ", "s;
-                    }
-                    first = false;
-                    out << "\""s << key << "\": "s << node;
-                }
-                out << '}';
-            }
+    size_t Dict::count(std::string_view key) const {
+        return find(key) != items_.end() ? 1 : 0;
+    }
 
-            void operator()(const std::string& value) {
-                out << '"' << OutPrepare(value) << '"';
-            }
+    Node& Dict::at(std::string_view key) {
+        return const_cast<Node&>(const_cast<const Dict&>(*this).at(key));
+    }
 
-            void operator()(std::nullptr_t) {
-                out << "null"s;
-            }
-        };
+    const Node& Dict::at(std::string_view key) const {
+        const const_iterator it = find(key);
+        if (it == items_.end()) {
+            throw std::out_of_range("Key \""s + std::string(key) + "\" is not found"s);
+        }
+        return it->second;
+    }
 
-    }  // namespace
+    std::pair<Dict::iterator, bool> Dict::emplace(std::string key, Node value) {
+        //Ключи часто приходят уже по порядку, тогда пара просто дописывается в конец
+        iterator it = items_.empty() || items_.back().first < key ? items_.end() : LowerBound(key);
+        if (it != items_.end() && it->first == key) {
+            return {it, false};
+        }
+        return {items_.emplace(it, move(key), move(value)), true};
+    }
+
+    bool Dict::operator==(const Dict& other) const {
+        return items_ == other.items_;
+    }
+
+    bool Dict::operator!=(const Dict& other) const {
+        return !(*this == other);
+    }
+
+    Dict::iterator Dict::LowerBound(std::string_view key) {
+        return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+            return item.first < key;
+        });
+    }
+
+    Dict::const_iterator Dict::LowerBound(std::string_view key) const {
+        return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+            return item.first < key;
+        });
+    }
 
     //Node
     const Array& Node::AsArray() const {
@@ -425,7 +608,7 @@ namespace json {
     }
 
     std::ostream& operator<<(std::ostream& o, const Node& node) {
-        std::visit(DataPrinter{o}, static_cast<const Data&>(node));
+        Writer(o).WriteNode(node);
         return o;
     }
 
@@ -444,12 +627,152 @@ namespace json {
         return !(*this == other);
     }
 
+    //TreeBuilder
+    template <typename Value>
+    void TreeBuilder::AddValue(Value&& value) {
+        if (frames_.empty()) {
+            root_ = Node(std::forward<Value>(value));
+            complete_ = true;
+        } else if (frames_.back().is_dict) {
+            //Ключ уже добавлен в OnKey, осталось значение
+            items_.back().second = Node(std::forward<Value>(value));
+        } else {
+            arrays_.back().emplace_back(std::forward<Value>(value));
+        }
+    }
+
+    void TreeBuilder::OnNull() {
+        AddValue(nullptr);
+    }
+
+    void TreeBuilder::OnBool(bool value) {
+        AddValue(value);
+    }
+
+    void TreeBuilder::OnInt(int value) {
+        AddValue(value);
+    }
+
+    void TreeBuilder::OnDouble(double value) {
+        AddValue(value);
+    }
+
+    void TreeBuilder::OnString(std::string_view value) {
+        AddValue(std::string(value));
+    }
+
+    void TreeBuilder::OnKey(std::string_view key) {
+        Frame& frame = frames_.back();
+        const size_t begin = frame.begin;
+        const size_t count = items_.size() - begin;
+        bool is_duplicate = false;
+        if (count < SMALL_DICT_SIZE) {
+            //Словари в JSON обычно небольшие, в них повтор ищем простым перебором
+            is_duplicate = std::any_of(items_.begin() + static_cast<ptrdiff_t>(begin), items_.end(),
+                                       [key](const Dict::value_type& item) {
+                                           return item.first == key;
+                                       });
+        } else {
+            const std::hash<std::string_view> hasher;
+            if (count == SMALL_DICT_SIZE) {
+                for (size_t i = begin; i < items_.size(); ++i) {
+                    frame.big_keys.emplace(hasher(items_[i].first), i);
+                }
+            }
+            const size_t hash = hasher(key);
+            const auto [first, last] = frame.big_keys.equal_range(hash);
+            is_duplicate = std::any_of(first, last, [this, key](const auto& entry) {
+                return items_[entry.second].first == key;
+            });
+            frame.big_keys.emplace(hash, items_.size());
+        }
+        if (is_duplicate) {
+            throw ParsingError("Failed attempt to parse Dictionary! Duplicate key \""s
+                               + std::string(key) + "\" have been found"s);
+        }
+        items_.emplace_back(std::string(key), Node());
+    }
+
+    void TreeBuilder::OnStartArray() {
+        frames_.push_back({false, 0});
+        arrays_.emplace_back();
+    }
+
+    void TreeBuilder::OnEndArray() {
+        Array array = move(arrays_.back());
+        arrays_.pop_back();
+        frames_.pop_back();
+        AddValue(move(array));
+    }
+
+    void TreeBuilder::OnStartDict() {
+        frames_.push_back({true, items_.size()});
+    }
+
+    void TreeBuilder::OnEndDict() {
+        const size_t begin = frames_.back().begin;
+        const size_t count = items_.size() - begin;
+        std::vector<Dict::value_type> sorted;
+        sorted.reserve(count);
+        if (count <= SMALL_DICT_SIZE) {
+            //Небольшой словарь упорядочиваем по номерам, чтобы каждая пара переместилась один раз
+            uint8_t order[SMALL_DICT_SIZE];
+            for (size_t i = 0; i < count; ++i) {
+                size_t hole = i;
+                for (; hole > 0 && items_[begin + i].first < items_[begin + order[hole - 1]].first; --hole) {
+                    order[hole] = order[hole - 1];
+                }
+                order[hole] = static_cast<uint8_t>(i);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                sorted.push_back(move(items_[begin + order[i]]));
+            }
+        } else {
+            sorted.assign(make_move_iterator(items_.begin() + static_cast<ptrdiff_t>(begin)),
+                          make_move_iterator(items_.end()));
+        }
+        Dict dict(move(sorted));
+        items_.resize(begin);
+        frames_.pop_back();
+        AddValue(move(dict));
+    }
+
+    bool TreeBuilder::IsComplete() const {
+        return complete_;
+    }
+
+    Node TreeBuilder::Extract() {
+        complete_ = false;
+        return move(root_);
+    }
+
+    void Parse(std::string_view text, EventHandler& handler) {
+        Parser<EventHandler>(text, handler).ParseValue();
+    }
+
+    void ParseFile(const std::string& path, EventHandler& handler) {
+        MappedFile file(path);
+        Parser<EventHandler>(file.GetText(), handler, &file).ParseValue();
+    }
+
     Document Load(istream& input) {
-        return Document{LoadNode(input)};
+        const std::string text{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+        return Load(text);
+    }
+
+    Document Load(std::string_view input) {
+        TreeBuilder builder;
+        Parser<TreeBuilder>(input, builder).ParseValue();
+        return Document{builder.Extract()};
+    }
+
+    Document LoadFile(const std::string& path) {
+        const MappedFile file(path);
+        return Load(file.GetText());
     }
 
     void Print(const Document& doc, std::ostream& output) {
-        output << doc.GetRoot();
+        Writer(output).WriteNode(doc.GetRoot());
     }
 
 }  // namespace json
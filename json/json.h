@@ -1,17 +1,64 @@
 #pragma once
 
+#include <initializer_list>
 #include <iostream>
-#include <map>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <variant>
 
 namespace json {
 
     class Builder;
+    class Writer;
 
     class Node;
-    using Dict = std::map<std::string, Node>;
+
+    /*
+     * Словарь JSON. Пары лежат в одном векторе по возрастанию ключа, поэтому обходится и печатается
+     * словарь в том же порядке, что и std::map. Поиск принимает string_view без временных строк
+     */
+    class Dict {
+    public:
+        using value_type = std::pair<std::string, Node>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        Dict() = default;
+        // Из повторяющихся ключей остаётся первый, как и у std::map
+        Dict(std::initializer_list<value_type> items);
+        explicit Dict(std::vector<value_type> items);
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        size_t size() const;
+        bool empty() const;
+
+        iterator find(std::string_view key);
+        const_iterator find(std::string_view key) const;
+        size_t count(std::string_view key) const;
+
+        // Бросают std::out_of_range, если ключа нет
+        Node& at(std::string_view key);
+        const Node& at(std::string_view key) const;
+
+        // Добавляет пару, если такого ключа ещё нет. Возвращает позицию ключа и признак вставки
+        std::pair<iterator, bool> emplace(std::string key, Node value);
+
+        bool operator==(const Dict& other) const;
+        bool operator!=(const Dict& other) const;
+
+    private:
+        std::vector<value_type> items_;
+
+        iterator LowerBound(std::string_view key);
+        const_iterator LowerBound(std::string_view key) const;
+    };
+
     using Array = std::vector<Node>;
     using Data = std::variant<std::nullptr_t, Array, Dict, int, double, std::string, bool>;
 
@@ -51,6 +98,7 @@ namespace json {
 
         friend std::ostream& operator<<(std::ostream&, const Node& node);
         friend class Builder;
+        friend class Writer;
 
     private:
 
@@ -77,8 +125,86 @@ namespace json {
         Node root_;
     };
 
+    /*
+     * Обработчик потокового разбора. Значения приходят в порядке текста, словарь - парами OnKey и значение.
+     * Строки и ключи передаются string_view, который действует только до возврата из обработчика
+     */
+    class EventHandler {
+    public:
+        virtual ~EventHandler() = default;
+
+        virtual void OnNull() = 0;
+        virtual void OnBool(bool value) = 0;
+        virtual void OnInt(int value) = 0;
+        virtual void OnDouble(double value) = 0;
+        virtual void OnString(std::string_view value) = 0;
+        virtual void OnKey(std::string_view key) = 0;
+        virtual void OnStartArray() = 0;
+        virtual void OnEndArray() = 0;
+        virtual void OnStartDict() = 0;
+        virtual void OnEndDict() = 0;
+    };
+
+    // Собирает из событий дерево узлов. На повторяющемся ключе словаря бросает ParsingError, как и Load
+    class TreeBuilder final : public EventHandler {
+    public:
+        void OnNull() override;
+        void OnBool(bool value) override;
+        void OnInt(int value) override;
+        void OnDouble(double value) override;
+        void OnString(std::string_view value) override;
+        void OnKey(std::string_view key) override;
+        void OnStartArray() override;
+        void OnEndArray() override;
+        void OnStartDict() override;
+        void OnEndDict() override;
+
+        // Корневое значение закрыто
+        bool IsComplete() const;
+
+        // Забирает корень. После вызова строитель готов к новому дереву
+        Node Extract();
+
+    private:
+        // Открытый массив или словарь. Пары словаря лежат в items_ начиная с begin
+        struct Frame {
+            bool is_dict = false;
+            size_t begin = 0;
+            // Хэш ключа -> номер пары в items_. Заполняется только для больших словарей,
+            // чтобы поиск повтора не перебирал все ключи. У каждого словаря свой: ключи
+            // внешнего словаря не должны считаться повторами во вложенном
+            std::unordered_multimap<size_t, size_t> big_keys;
+        };
+
+        static constexpr size_t SMALL_DICT_SIZE = 16;
+
+        std::vector<Frame> frames_;
+        // Открытые массивы, элементы добавляются в них сразу
+        std::vector<Array> arrays_;
+        // Пары всех открытых словарей подряд. Словарь собирается при закрытии, уже нужного размера
+        std::vector<Dict::value_type> items_;
+        Node root_;
+        bool complete_ = false;
+
+        template <typename Value>
+        void AddValue(Value&& value);
+    };
+
+    // Разбирает text, сообщая о значениях handler. Ошибки синтаксиса те же, что у Load
+    void Parse(std::string_view text, EventHandler& handler);
+
+    // Как Parse, но читает отображённый в память файл. Прочитанные страницы сразу отдаются системе
+    void ParseFile(const std::string& path, EventHandler& handler);
+
+    // Читает поток до конца и разбирает его как Load(std::string_view)
     Document Load(std::istream& input);
 
+    // Разбирает JSON из непрерывного буфера. Документ хранит свои копии строк, буфер можно освобождать
+    Document Load(std::string_view input);
+
+    // Отображает файл path в память и разбирает его. Бросает std::runtime_error, если файл не открылся
+    Document LoadFile(const std::string& path);
+
     void Print(const Document& doc, std::ostream& output);
 
 }  // namespace json
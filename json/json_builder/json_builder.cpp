@@ -78,7 +78,7 @@ namespace json {
     }
 
     Node* Builder::InsertIntoMap(Node& current_node, const std::string& key, Node&& value) {
-        auto [it, inserted] = current_node.AsMap().insert({key, std::move(value)});
+        auto [it, inserted] = current_node.AsMap().emplace(key, std::move(value));
         if (!inserted) {
             throw std::logic_error("Failed attempt to insert in Dictionary! Duplicate key \""s
                                + key + "\" have been found"s);
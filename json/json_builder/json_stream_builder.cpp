@@ -0,0 +1,150 @@
+#include "json_stream_builder.h"
+
+using namespace std::literals;
+
+namespace json {
+
+    StreamBuilder::StreamBuilder(std::ostream& output)
+        : writer_(output) {
+    }
+
+    StreamBuilder::KeyContext StreamBuilder::Key(std::string_view key) {
+        if (levels_.empty() || !levels_.back().is_dict) {
+            throw std::logic_error("Key() can be called only when Dict construction started!"s);
+        } else if (is_key_ready_) {
+            throw std::logic_error("Double key setting! Current attempt key value: \""s + std::string(key) + '"');
+        }
+        Level& level = levels_.back();
+        if (!level.is_empty) {
+            writer_.WriteRaw(", "sv);
+        }
+        level.is_empty = false;
+        writer_.WriteString(key);
+        writer_.WriteRaw(": "sv);
+        is_key_ready_ = true;
+        return KeyContext(*this);
+    }
+
+    StreamBuilder& StreamBuilder::Value(std::nullptr_t) {
+        BeginValue();
+        writer_.WriteNull();
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::Value(bool value) {
+        BeginValue();
+        writer_.WriteBool(value);
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::Value(int value) {
+        BeginValue();
+        writer_.WriteInt(value);
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::Value(double value) {
+        BeginValue();
+        writer_.WriteDouble(value);
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::Value(std::string_view value) {
+        BeginValue();
+        writer_.WriteString(value);
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+
+    StreamBuilder& StreamBuilder::Value(const std::string& value) {
+        return Value(std::string_view(value));
+    }
+
+    StreamBuilder& StreamBuilder::Value(RawJson value) {
+        BeginValue();
+        writer_.WriteRaw(value.text);
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::Value(const Node& value) {
+        BeginValue();
+        writer_.WriteNode(value);
+        return *this;
+    }
+
+    StreamBuilder::ArrayContext StreamBuilder::StartArray() {
+        BeginValue();
+        writer_.WriteRaw("["sv);
+        levels_.push_back({false});
+        return ArrayContext(*this);
+    }
+
+    StreamBuilder::DictContext StreamBuilder::StartDict() {
+        BeginValue();
+        writer_.WriteRaw("{"sv);
+        levels_.push_back({true});
+        return DictContext(*this);
+    }
+
+    StreamBuilder& StreamBuilder::EndArray() {
+        EndContainer(false);
+        writer_.WriteRaw("]"sv);
+        return *this;
+    }
+
+    StreamBuilder& StreamBuilder::EndDict() {
+        EndContainer(true);
+        writer_.WriteRaw("}"sv);
+        return *this;
+    }
+
+    void StreamBuilder::Finish() {
+        if (!is_document_defined_ || !levels_.empty()) {
+            throw std::logic_error("JSON is not finished"s);
+        }
+        writer_.Flush();
+    }
+
+    void StreamBuilder::BeginValue() {
+        if (levels_.empty()) {
+            //Вне контейнеров можно вывести только корень
+            if (is_document_defined_) {
+                throw std::logic_error("Calling Value() in the wrong context! Document already finished"s);
+            }
+            is_document_defined_ = true;
+            return;
+        }
+        Level& level = levels_.back();
+        if (level.is_dict) {
+            if (!is_key_ready_) {
+                throw std::logic_error("Failed attempt to insert into Dict! Key is not specified"s);
+            }
+            //Разделитель уже выведен вместе с ключом
+            is_key_ready_ = false;
+            return;
+        }
+        if (!level.is_empty) {
+            writer_.WriteRaw(", "sv);
+        }
+        level.is_empty = false;
+    }
+
+    void StreamBuilder::EndContainer(bool is_dict) {
+        const std::string container_name = is_dict ? "Dict"s : "Array"s;
+        if (!is_document_defined_) {
+            throw std::logic_error("Failed attempt to close "s + container_name + "! Document is not defined yet"s);
+        } else if (levels_.empty()) {
+            throw std::logic_error("Failed attempt to close "s + container_name + "! Document already finished"s);
+        } else if (levels_.back().is_dict != is_dict) {
+            throw std::logic_error("Failed attempt to close "s + container_name
+                                   + "! The order of ending is violated"s);
+        } else if (is_dict && is_key_ready_) {
+            throw std::logic_error("Failed attempt to close "s + container_name + "! An unclosed key found"s);
+        }
+        levels_.pop_back();
+    }
+
+} // namespace json
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "json/json.h"
+#include "json/json_writer.h"
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace json {
+
+    /*
+     * То же, что Builder, но значения сразу уходят в поток, дерево узлов не строится.
+     * Ключи словаря выводятся в порядке вызовов и на повторы не проверяются
+     */
+    class StreamBuilder {
+
+        class ArrayContext;
+        class DictContext;
+        class KeyContext;
+
+        class BaseContext {
+        public:
+            BaseContext(StreamBuilder& builder) : builder_(builder) {}
+
+            template <typename T>
+            void Value(const T& value) {
+                builder_.Value(value);
+            }
+
+            template <typename Print>
+            void StringValueFrom(Print&& print) {
+                builder_.StringValueFrom(std::forward<Print>(print));
+            }
+
+            ArrayContext StartArray() {
+                return builder_.StartArray();
+            }
+
+            DictContext StartDict() {
+                return builder_.StartDict();
+            }
+
+            KeyContext Key(std::string_view key) {
+                return builder_.Key(key);
+            }
+
+            StreamBuilder& EndArray() {
+                return builder_.EndArray();
+            }
+
+            StreamBuilder& EndDict() {
+                return builder_.EndDict();
+            }
+        private:
+            StreamBuilder& builder_;
+        };
+
+        class ArrayContext : public BaseContext {
+        public:
+            using BaseContext::BaseContext;
+
+            template <typename T>
+            ArrayContext& Value(const T& value) {
+                BaseContext::Value(value);
+                return *this;
+            }
+
+            template <typename Print>
+            ArrayContext& StringValueFrom(Print&& print) {
+                BaseContext::StringValueFrom(std::forward<Print>(print));
+                return *this;
+            }
+
+            KeyContext Key(std::string_view key) = delete;
+            StreamBuilder& EndDict() = delete;
+        };
+
+        class DictContext : public BaseContext {
+        public:
+            using BaseContext::BaseContext;
+            StreamBuilder& EndArray() = delete;
+            DictContext StartDict() = delete;
+            ArrayContext StartArray() = delete;
+            template <typename T>
+            void Value(const T& value) = delete;
+            template <typename Print>
+            void StringValueFrom(Print&& print) = delete;
+        };
+
+        class KeyContext : public DictContext {
+        public:
+            using DictContext::DictContext;
+            using BaseContext::StartArray;
+            using BaseContext::StartDict;
+
+            template <typename T>
+            DictContext& Value(const T& value) {
+                BaseContext::Value(value);
+                return *this;
+            }
+
+            template <typename Print>
+            DictContext& StringValueFrom(Print&& print) {
+                BaseContext::StringValueFrom(std::forward<Print>(print));
+                return *this;
+            }
+
+            KeyContext Key(std::string_view key) = delete;
+            StreamBuilder& EndDict() = delete;
+        };
+
+    public:
+        explicit StreamBuilder(std::ostream& output);
+
+        KeyContext Key(std::string_view key);
+
+        StreamBuilder& Value(std::nullptr_t);
+        StreamBuilder& Value(bool value);
+        StreamBuilder& Value(int value);
+        StreamBuilder& Value(double value);
+        StreamBuilder& Value(std::string_view value);
+        StreamBuilder& Value(const char* value);
+        StreamBuilder& Value(const std::string& value);
+        // Готовый фрагмент JSON выводится без изменений
+        StreamBuilder& Value(RawJson value);
+        // Узел выводится целиком, без копирования
+        StreamBuilder& Value(const Node& value);
+        // Строка, текст которой print выводит в переданный ему std::ostream. См. Writer::WriteStringFrom
+        template <typename Print>
+        StreamBuilder& StringValueFrom(Print&& print);
+
+        ArrayContext StartArray();
+        StreamBuilder& EndArray();
+
+        DictContext StartDict();
+        StreamBuilder& EndDict();
+
+        // Проверяет, что значение закончено, и отдаёт потоку остаток буфера
+        void Finish();
+
+        StreamBuilder(const StreamBuilder&) = delete;
+        StreamBuilder& operator=(const StreamBuilder&) = delete;
+
+    private:
+        // Открытый массив или словарь
+        struct Level {
+            bool is_dict = false;
+            bool is_empty = true;
+        };
+
+        Writer writer_;
+        std::vector<Level> levels_;
+        bool is_document_defined_ = false;
+        bool is_key_ready_ = false;
+
+        // Проверяет, что значение можно вывести, и выводит разделитель перед ним
+        void BeginValue();
+        void EndContainer(bool is_dict);
+    };
+
+    template <typename Print>
+    StreamBuilder& StreamBuilder::StringValueFrom(Print&& print) {
+        BeginValue();
+        writer_.WriteStringFrom(std::forward<Print>(print));
+        return *this;
+    }
+
+} // namespace json
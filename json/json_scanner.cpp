@@ -0,0 +1,206 @@
+#include "json_scanner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define JSON_X86_KERNELS
+#endif
+
+using namespace std::literals;
+
+namespace json {
+
+    namespace {
+
+        constexpr size_t BLOCK_SIZE = 64;
+        constexpr size_t CHUNK_SIZE = BLOCK_SIZE * 1024;
+
+        // Битовые маски одного блока, бит i соответствует байту i
+        struct BlockMasks {
+            uint64_t quote = 0;
+            uint64_t backslash = 0;
+            uint64_t space = 0;     // ' ', \t, \n, \r, \v, \f
+            uint64_t line_end = 0;  // \n, \r
+            uint64_t op = 0;        // { } [ ] : ,
+        };
+
+        BlockMasks ClassifyScalar(const char* block) {
+            BlockMasks masks;
+            for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                const uint64_t bit = uint64_t{1} << i;
+                switch (block[i]) {
+                    case '"': masks.quote |= bit; break;
+                    case '\\': masks.backslash |= bit; break;
+                    case '\n': case '\r': masks.line_end |= bit; masks.space |= bit; break;
+                    case ' ': case '\t': case '\v': case '\f': masks.space |= bit; break;
+                    case '{': case '}': case '[': case ']': case ':': case ',': masks.op |= bit; break;
+                    default: break;
+                }
+            }
+            return masks;
+        }
+
+#ifdef JSON_X86_KERNELS
+        //Классы считаются сравнениями на равенство, на каждый класс - одна movemask на вектор
+        __attribute__((target("avx2")))
+        BlockMasks ClassifyAvx2(const char* block) {
+            BlockMasks masks;
+            for (unsigned half = 0; half < 2; ++half) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + half * 32));
+                auto eq = [v](char c) __attribute__((target("avx2"))) {
+                    return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+                };
+                auto to_mask = [half](__m256i matches) __attribute__((target("avx2"))) {
+                    return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(matches))) << (half * 32);
+                };
+                const __m256i line_end = _mm256_or_si256(eq('\n'), eq('\r'));
+                const __m256i space = _mm256_or_si256(_mm256_or_si256(line_end, eq(' ')),
+                                                      _mm256_or_si256(eq('\t'), _mm256_or_si256(eq('\v'), eq('\f'))));
+                const __m256i op = _mm256_or_si256(
+                        _mm256_or_si256(_mm256_or_si256(eq('{'), eq('}')), _mm256_or_si256(eq('['), eq(']'))),
+                        _mm256_or_si256(eq(':'), eq(',')));
+                masks.quote |= to_mask(eq('"'));
+                masks.backslash |= to_mask(eq('\\'));
+                masks.line_end |= to_mask(line_end);
+                masks.space |= to_mask(space);
+                masks.op |= to_mask(op);
+            }
+            return masks;
+        }
+
+        BlockMasks ClassifySse2(const char* block) {
+            BlockMasks masks;
+            for (unsigned quarter = 0; quarter < 4; ++quarter) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + quarter * 16));
+                auto eq = [v](char c) {
+                    return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+                };
+                auto to_mask = [quarter](__m128i matches) {
+                    return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(matches))) << (quarter * 16);
+                };
+                const __m128i line_end = _mm_or_si128(eq('\n'), eq('\r'));
+                const __m128i space = _mm_or_si128(_mm_or_si128(line_end, eq(' ')),
+                                                   _mm_or_si128(eq('\t'), _mm_or_si128(eq('\v'), eq('\f'))));
+                const __m128i op = _mm_or_si128(
+                        _mm_or_si128(_mm_or_si128(eq('{'), eq('}')), _mm_or_si128(eq('['), eq(']'))),
+                        _mm_or_si128(eq(':'), eq(',')));
+                masks.quote |= to_mask(eq('"'));
+                masks.backslash |= to_mask(eq('\\'));
+                masks.line_end |= to_mask(line_end);
+                masks.space |= to_mask(space);
+                masks.op |= to_mask(op);
+            }
+            return masks;
+        }
+#endif
+
+        using Classifier = BlockMasks (*)(const char*);
+
+        Classifier ChooseClassifier() {
+#ifdef JSON_X86_KERNELS
+            if (__builtin_cpu_supports("avx2")) {
+                return ClassifyAvx2;
+            }
+            if (__builtin_cpu_supports("sse2")) {
+                return ClassifySse2;
+            }
+#endif
+            return ClassifyScalar;
+        }
+
+        // Префиксный xor: бит i результата - xor битов 0..i
+        uint64_t PrefixXor(uint64_t bits) {
+            bits ^= bits << 1;
+            bits ^= bits << 2;
+            bits ^= bits << 4;
+            bits ^= bits << 8;
+            bits ^= bits << 16;
+            bits ^= bits << 32;
+            return bits;
+        }
+
+        // Символы, стоящие сразу после нечётной серии обратных косых черт
+        uint64_t FindEscaped(uint64_t backslash, bool& prev_escaped) {
+            if (backslash == 0 && !prev_escaped) {
+                return 0;
+            }
+            //Обратные косые черты встречаются редко, поэтому серии разбираем по битам
+            uint64_t escaped = 0;
+            bool escaping = prev_escaped;
+            for (unsigned i = 0; i < BLOCK_SIZE; ++i) {
+                const uint64_t bit = uint64_t{1} << i;
+                if (escaping) {
+                    escaped |= bit;
+                    escaping = false;
+                } else if (backslash & bit) {
+                    escaping = true;
+                }
+            }
+            prev_escaped = escaping;
+            return escaped;
+        }
+
+        // Дописывает в index позиции блока, начинающегося с offset
+        void ScanBlock(const BlockMasks& masks, uint32_t offset, StructuralScanner::State& state,
+                       std::vector<uint32_t>& index) {
+            const uint64_t escaped = FindEscaped(masks.backslash, state.prev_escaped);
+            const uint64_t quote = masks.quote & ~escaped;
+
+            //Маска строки включает открывающую кавычку и не включает закрывающую
+            const uint64_t in_string = PrefixXor(quote) ^ state.prev_in_string;
+            state.prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+            //Скаляр - всё, что вне строк и не пробел, не кавычка и не оператор. Отмечаем только начало
+            const uint64_t scalar = ~(masks.space | masks.op | quote | in_string);
+            const uint64_t scalar_start = scalar & ~((scalar << 1) | state.prev_scalar);
+            state.prev_scalar = scalar >> 63;
+
+            const uint64_t string_special = in_string & ~escaped & (masks.backslash | masks.line_end);
+            uint64_t bits = (masks.op & ~in_string) | quote | scalar_start | string_special;
+
+            const size_t size = index.size();
+            index.resize(size + static_cast<size_t>(__builtin_popcountll(bits)));
+            uint32_t* out = index.data() + size;
+            while (bits != 0) {
+                *out++ = offset + static_cast<uint32_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+
+    } // namespace
+
+    StructuralScanner::StructuralScanner(std::string_view text)
+        : text_(text) {
+        if (text.size() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("JSON input is too large"s);
+        }
+    }
+
+    bool StructuralScanner::ScanNext(std::vector<uint32_t>& index) {
+        static const Classifier classify = ChooseClassifier();
+
+        index.clear();
+        if (offset_ >= text_.size()) {
+            return false;
+        }
+        //Участок - кратное блоку число байт, индекс к нему переиспользуется между вызовами
+        const size_t chunk_end = std::min(text_.size(), offset_ + CHUNK_SIZE);
+        for (; offset_ + BLOCK_SIZE <= chunk_end; offset_ += BLOCK_SIZE) {
+            ScanBlock(classify(text_.data() + offset_), static_cast<uint32_t>(offset_), state_, index);
+        }
+        if (offset_ < chunk_end) {
+            //Хвост дополняем пробелами: они ничего не добавляют в индекс
+            char tail[BLOCK_SIZE];
+            std::memset(tail, ' ', BLOCK_SIZE);
+            std::memcpy(tail, text_.data() + offset_, chunk_end - offset_);
+            ScanBlock(classify(tail), static_cast<uint32_t>(offset_), state_, index);
+            offset_ = chunk_end;
+        }
+        return true;
+    }
+
+} // namespace json
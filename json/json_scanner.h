@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+    /*
+     * Первый проход разбора: классифицирует символы блоками по 64 байта (AVX2, SSE2 или побайтно)
+     * и выдаёт по возрастанию позиции, на которых второму проходу нужно остановиться:
+     *  - символы {}[]:, вне строк;
+     *  - неэкранированные кавычки, открывающие и закрывающие;
+     *  - первый символ каждого скаляра (числа, true, false, null) вне строк;
+     *  - внутри строк - начала escape-последовательностей и переводы строк \n, \r.
+     * Экранированные символы в индекс не попадают. Текст просматривается участками,
+     * так что индекс занимает память по размеру участка, а не всего текста
+     */
+    class StructuralScanner {
+    public:
+        // Бросает std::length_error для текста длиннее 4 ГБ
+        explicit StructuralScanner(std::string_view text);
+
+        // Заменяет содержимое index позициями следующего участка. Возвращает false, если текст кончился
+        bool ScanNext(std::vector<uint32_t>& index);
+
+        // Состояние, переходящее из блока в блок
+        struct State {
+            uint64_t prev_in_string = 0;  // все единицы, если блок закончился внутри строки
+            uint64_t prev_scalar = 0;
+            bool prev_escaped = false;    // последний байт блока - начало escape-последовательности
+        };
+
+    private:
+        std::string_view text_;
+        size_t offset_ = 0;
+        State state_;
+    };
+
+} // namespace json
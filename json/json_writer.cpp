@@ -0,0 +1,201 @@
+#include "json_writer.h"
+
+#include <array>
+#include <charconv>
+#include <variant>
+
+using namespace std::literals;
+
+namespace json {
+
+    namespace {
+
+        // Второй символ escape-последовательности для байта, 0 - байт выводится как есть
+        constexpr std::array<char, 256> MakeEscapes() {
+            std::array<char, 256> escapes{};
+            escapes['\\'] = '\\';
+            escapes['"'] = '"';
+            escapes['\n'] = 'n';
+            escapes['\r'] = 'r';
+            escapes['\t'] = 't';
+            return escapes;
+        }
+
+        constexpr std::array<char, 256> ESCAPES = MakeEscapes();
+
+        struct NodePrinter {
+            Writer& writer;
+
+            void operator()(std::nullptr_t) {
+                writer.WriteNull();
+            }
+
+            void operator()(bool value) {
+                writer.WriteBool(value);
+            }
+
+            void operator()(int value) {
+                writer.WriteInt(value);
+            }
+
+            void operator()(double value) {
+                writer.WriteDouble(value);
+            }
+
+            void operator()(const std::string& value) {
+                writer.WriteString(value);
+            }
+
+            void operator()(const Array& array) {
+                writer.WriteRaw("["sv);
+                bool first = true;
+                for (const Node& node : array) {
+                    if (!first) {
+                        writer.WriteRaw(", "sv);
+                    }
+                    first = false;
+                    writer.WriteNode(node);
+                }
+                writer.WriteRaw("]"sv);
+            }
+
+            void operator()(const Dict& dict) {
+                writer.WriteRaw("{"sv);
+                bool first = true;
+                for (const auto& [key, node] : dict) {
+                    if (!first) {
+                        writer.WriteRaw(", "sv);
+                    }
+                    first = false;
+                    writer.WriteString(key);
+                    writer.WriteRaw(": "sv);
+                    writer.WriteNode(node);
+                }
+                writer.WriteRaw("}"sv);
+            }
+        };
+
+    } // namespace
+
+    Writer::Writer(std::ostream& output)
+        : output_(&output)
+        , buffer_(own_buffer_) {
+        buffer_.reserve(FLUSH_SIZE);
+    }
+
+    Writer::Writer(std::string& target)
+        : buffer_(target) {
+    }
+
+    Writer::~Writer() {
+        Flush();
+    }
+
+    void Writer::WriteNull() {
+        WriteRaw("null"sv);
+    }
+
+    void Writer::WriteBool(bool value) {
+        WriteRaw(value ? "true"sv : "false"sv);
+    }
+
+    void Writer::WriteInt(int value) {
+        char digits[16];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        WriteRaw({digits, static_cast<size_t>(result.ptr - digits)});
+    }
+
+    void Writer::WriteDouble(double value) {
+        //Без точности to_chars выбирает самую короткую запись, однозначно задающую число
+        char digits[32];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        WriteRaw({digits, static_cast<size_t>(result.ptr - digits)});
+    }
+
+    void Writer::WriteString(std::string_view value) {
+        buffer_.push_back('"');
+        WriteEscaped(value);
+        buffer_.push_back('"');
+        FlushIfFull();
+    }
+
+    void Writer::WriteRaw(std::string_view text) {
+        if (output_ && text.size() >= FLUSH_SIZE) {
+            //Большой фрагмент идёт в поток сам, минуя буфер
+            Flush();
+            output_->write(text.data(), static_cast<std::streamsize>(text.size()));
+            return;
+        }
+        buffer_.append(text);
+        FlushIfFull();
+    }
+
+    void Writer::WriteNode(const Node& node) {
+        std::visit(NodePrinter{*this}, static_cast<const Data&>(node));
+    }
+
+    void Writer::Flush() {
+        if (output_ && !buffer_.empty()) {
+            output_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+    }
+
+    void Writer::WriteEscaped(std::string_view text) {
+        //Участки без спецсимволов копируются целиком
+        size_t clean_begin = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char escape = ESCAPES[static_cast<unsigned char>(text[i])];
+            if (escape != 0) {
+                buffer_.append(text.data() + clean_begin, i - clean_begin);
+                buffer_.push_back('\\');
+                buffer_.push_back(escape);
+                clean_begin = i + 1;
+            }
+        }
+        buffer_.append(text.data() + clean_begin, text.size() - clean_begin);
+    }
+
+    void Writer::FlushIfFull() {
+        if (buffer_.size() >= FLUSH_SIZE) {
+            Flush();
+        }
+    }
+
+    //EscapingBuf
+    Writer::EscapingBuf::EscapingBuf(Writer& writer)
+        : writer_(writer) {
+        setp(chars_, chars_ + sizeof(chars_));
+    }
+
+    Writer::EscapingBuf::~EscapingBuf() {
+        sync();
+    }
+
+    Writer::EscapingBuf::int_type Writer::EscapingBuf::overflow(int_type c) {
+        sync();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize Writer::EscapingBuf::xsputn(const char* text, std::streamsize size) {
+        //Куски текста экранируются сразу, минуя chars_
+        sync();
+        writer_.WriteEscaped({text, static_cast<size_t>(size)});
+        writer_.FlushIfFull();
+        return size;
+    }
+
+    int Writer::EscapingBuf::sync() {
+        if (pptr() != pbase()) {
+            writer_.WriteEscaped({pbase(), static_cast<size_t>(pptr() - pbase())});
+            writer_.FlushIfFull();
+            setp(chars_, chars_ + sizeof(chars_));
+        }
+        return 0;
+    }
+
+} // namespace json
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "json.h"
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+    // Уже сериализованный фрагмент JSON, который писатель выводит как есть.
+    // Узлом дерева не бывает: текст не копируется и должен жить, пока его не выведут
+    struct RawJson {
+        std::string_view text;
+    };
+
+    /*
+     * Буферизованный вывод JSON. Текст копится в буфере и уходит в поток блоками, как только
+     * набирается FLUSH_SIZE байт, либо целиком остаётся в строке-приёмнике.
+     * Дробные числа печатаются кратчайшей записью, которая читается обратно в то же самое число
+     */
+    class Writer {
+    public:
+        static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+        explicit Writer(std::ostream& output);
+        // Дописывает весь текст в конец target
+        explicit Writer(std::string& target);
+        // Отдаёт потоку остаток буфера
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        void WriteNull();
+        void WriteBool(bool value);
+        void WriteInt(int value);
+        void WriteDouble(double value);
+        // Строка в кавычках, символы \ " \n \r \t экранируются
+        void WriteString(std::string_view value);
+        // То же, но текст строки print выводит в переданный ему std::ostream и сразу экранируется,
+        // целиком строка нигде не хранится
+        template <typename Print>
+        void WriteStringFrom(Print&& print);
+        // Уже готовый текст, выводится без изменений
+        void WriteRaw(std::string_view text);
+        void WriteNode(const Node& node);
+
+        void Flush();
+
+    private:
+        // Экранирует всё, что в него выводят, прямо в буфер писателя
+        class EscapingBuf : public std::streambuf {
+        public:
+            explicit EscapingBuf(Writer& writer);
+            ~EscapingBuf() override;
+
+        protected:
+            int_type overflow(int_type c) override;
+            std::streamsize xsputn(const char* text, std::streamsize size) override;
+            int sync() override;
+
+        private:
+            Writer& writer_;
+            // Одиночные символы копятся здесь, чтобы не экранировать их по одному
+            char chars_[256];
+        };
+
+        std::ostream* output_ = nullptr;
+        std::string own_buffer_;
+        std::string& buffer_;
+
+        void WriteEscaped(std::string_view text);
+        void FlushIfFull();
+    };
+
+    template <typename Print>
+    void Writer::WriteStringFrom(Print&& print) {
+        buffer_.push_back('"');
+        {
+            EscapingBuf escaping_buf(*this);
+            std::ostream out(&escaping_buf);
+            print(out);
+        }
+        buffer_.push_back('"');
+        FlushIfFull();
+    }
+
+} // namespace json
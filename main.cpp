@@ -1,27 +1,107 @@
 #include "service/json_reader/json_reader.h"
-#include "transport_catalogue/transport_catalogue.h"
+#include "transport_catalogue/catalogue_snapshot.h"
 
 #include <iostream>
 #include <fstream>
+#include <string_view>
 
 using namespace std;
 using namespace transport_catalogue;
 
-int main() {
-    TransportCatalogue transport;
-
-    service::JsonReader json_reader(transport);
+void PrintUsage(ostream& stream = cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests] [input json]\n"sv
+           << "       transport_catalogue make_delta <old base json>\n"sv;
+}
 
-    json_reader.ReadJson(cin);
-    json_reader.FillCatalogue();
+// Читает json из файла path, а если путь не задан - из stdin
+bool ReadInput(service::JsonReader& json_reader, const char* path) {
+    if (path == nullptr) {
+        json_reader.ReadJson(cin);
+        return true;
+    }
+    try {
+        json_reader.ReadJsonFile(path);
+    } catch (const runtime_error& error) {
+        cerr << error.what() << '\n';
+        return false;
+    }
+    return true;
+}
 
+bool WriteStats(const service::JsonReader& json_reader) {
     ofstream out("output.json"s);
     if (!out) {
         cerr << "Could not open output file!"sv;
-        return 0;
+        return false;
     }
 
     json_reader.GetStats(out);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    CataloguePublisher transport;
+
+    service::JsonReader json_reader(transport);
+
+    // Без аргументов и база, и запросы берутся из одного json'а
+    if (argc == 1) {
+        json_reader.ReadJson(cin);
+        json_reader.FillCatalogue();
+        WriteStats(json_reader);
+        return 0;
+    }
+
+    const string_view mode(argv[1]);
+
+    // Обновление строится по двум json'ам: старый передаётся аргументом, новый - через stdin
+    if (mode == "make_delta"sv && argc == 3) {
+        CataloguePublisher old_transport;
+        service::JsonReader old_json_reader(old_transport);
+        if (!ReadInput(old_json_reader, argv[2])) {
+            cerr << "Could not open old base json!"sv;
+            return 1;
+        }
+        old_json_reader.FillCatalogue(false);
+
+        json_reader.ReadJson(cin);
+        json_reader.FillCatalogue(false);
+        if (!json_reader.SaveDelta(*old_transport.Pin())) {
+            cerr << "Could not save delta!"sv;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 3) {
+        PrintUsage();
+        return 1;
+    }
+
+    // Входной json можно передать путём к файлу, тогда он отображается в память вместо чтения stdin
+    const char* input_path = argc == 3 ? argv[2] : nullptr;
+    if (mode == "make_base"sv) {
+        if (!ReadInput(json_reader, input_path)) {
+            return 1;
+        }
+        json_reader.FillCatalogue();
+        if (!json_reader.SaveBase()) {
+            cerr << "Could not save base!"sv;
+            return 1;
+        }
+    } else if (mode == "process_requests"sv) {
+        if (!ReadInput(json_reader, input_path)) {
+            return 1;
+        }
+        if (!json_reader.LoadBase()) {
+            cerr << "Could not load base!"sv;
+            return 1;
+        }
+        WriteStats(json_reader);
+    } else {
+        PrintUsage();
+        return 1;
+    }
 
     return 0;
 }
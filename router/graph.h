@@ -27,6 +27,7 @@ namespace graph {
         DirectedWeightedGraph() = default;
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
+        void AddVertexes(size_t count);
 
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
@@ -51,6 +52,11 @@ namespace graph {
         return id;
     }
 
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::AddVertexes(size_t count) {
+        incidence_lists_.resize(incidence_lists_.size() + count);
+    }
+
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
         return incidence_lists_.size();
@@ -22,6 +22,15 @@ namespace ranges {
         It end() const {
             return end_;
         }
+        size_t size() const {
+            return static_cast<size_t>(std::distance(begin_, end_));
+        }
+        bool empty() const {
+            return begin_ == end_;
+        }
+        decltype(auto) operator[](size_t index) const {
+            return begin_[index];
+        }
 
     private:
         It begin_;
@@ -20,7 +20,15 @@ namespace graph {
         using Graph = DirectedWeightedGraph<Weight>;
 
     public:
+        struct RouteInternalData {
+            Weight weight;
+            std::optional<EdgeId> prev_edge;
+        };
+        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
         explicit Router(const Graph& graph);
+        // Восстанавливает маршрутизатор по ранее посчитанным таблицам без пересчёта
+        Router(const Graph& graph, RoutesInternalData routes_internal_data);
 
         struct RouteInfo {
             Weight weight;
@@ -29,12 +37,15 @@ namespace graph {
 
         std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+        // Дополняет таблицы вершинами и рёбрами, добавленными в граф после построения.
+        // Релаксация идёт только через начала новых рёбер, а не через все вершины графа.
+        // Веса складываются в другом порядке, чем при построении заново, поэтому могут отличаться
+        // от него в последнем бите, а из маршрутов равного веса может остаться другой
+        void AddEdges(EdgeId first_new_edge);
+
+        const RoutesInternalData& GetRoutesInternalData() const;
+
     private:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
-        };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
         void InitializeRoutesInternalData(const Graph& graph) {
             const size_t vertex_count = graph.GetVertexCount();
@@ -94,6 +105,66 @@ namespace graph {
         }
     }
 
+    template <typename Weight>
+    Router<Weight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+            : graph_(graph)
+            , routes_internal_data_(std::move(routes_internal_data))
+    {
+        if (routes_internal_data_.size() != graph.GetVertexCount()) {
+            throw std::invalid_argument("Routes internal data doesn't match the graph");
+        }
+    }
+
+    template <typename Weight>
+    void Router<Weight>::AddEdges(EdgeId first_new_edge) {
+        const size_t old_vertex_count = routes_internal_data_.size();
+        const size_t vertex_count = graph_.GetVertexCount();
+
+        for (auto& row : routes_internal_data_) {
+            row.resize(vertex_count);
+        }
+        routes_internal_data_.resize(vertex_count, std::vector<std::optional<RouteInternalData>>(vertex_count));
+        for (VertexId vertex = old_vertex_count; vertex < vertex_count; ++vertex) {
+            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        }
+
+        std::vector<bool> is_source(vertex_count, false);
+        for (EdgeId edge_id = first_new_edge; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            auto& route_internal_data = routes_internal_data_[edge.from][edge.to];
+            if (!route_internal_data || route_internal_data->weight > edge.weight) {
+                route_internal_data = RouteInternalData{edge.weight, edge_id};
+            }
+            is_source[edge.from] = true;
+        }
+
+        // Маршруты, начинающиеся с нового ребра: после этого любой новый путь разбивается
+        // на куски, стыкующиеся только в началах новых рёбер
+        for (EdgeId edge_id = first_new_edge; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const RouteInternalData route_from{edge.weight, edge_id};
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                if (const auto& route_to = routes_internal_data_[edge.to][vertex_to]) {
+                    RelaxRoute(edge.from, vertex_to, route_from, *route_to);
+                }
+            }
+        }
+
+        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+            if (is_source[vertex_through]) {
+                RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+            }
+        }
+    }
+
+    template <typename Weight>
+    const typename Router<Weight>::RoutesInternalData& Router<Weight>::GetRoutesInternalData() const {
+        return routes_internal_data_;
+    }
+
     template <typename Weight>
     std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                                  VertexId to) const {
@@ -1,27 +1,30 @@
 #include "json_reader.h"
 
 #include <string>
-#include <deque>
 #include <vector>
 #include <unordered_map>
 #include <sstream>
+#include <fstream>
+#include <type_traits>
+#include <algorithm>
 
-#include "json/json_builder/json_builder.h"
 
 namespace transport_catalogue::service {
     using namespace std::literals;
 
-    double GetDoubleSetting(const json::Dict& list, const std::string& setting) {
-        return list.count(setting) > 0 && list.at(setting).IsDouble() ? list.at(setting).AsDouble() : 0.0;
+    double GetDoubleSetting(const json::Dict& list, std::string_view setting) {
+        const auto it = list.find(setting);
+        return it != list.end() && it->second.IsDouble() ? it->second.AsDouble() : 0.0;
     }
 
-    int GetIntSetting(const json::Dict& list, const std::string& setting) {
-        return list.count(setting) > 0 && list.at(setting).IsInt() ? list.at(setting).AsInt() : 0;
+    int GetIntSetting(const json::Dict& list, std::string_view setting) {
+        const auto it = list.find(setting);
+        return it != list.end() && it->second.IsInt() ? it->second.AsInt() : 0;
     }
 
-    svg::Point GetPointSetting(const json::Dict& list, const std::string& setting) {
-        if (list.count(setting) > 0) {
-            const json::Array& offsets = list.at(setting).AsArray();
+    svg::Point GetPointSetting(const json::Dict& list, std::string_view setting) {
+        if (const auto it = list.find(setting); it != list.end()) {
+            const json::Array& offsets = it->second.AsArray();
             return {
                     offsets.at(0).AsDouble(),
                     offsets.at(1).AsDouble(),
@@ -30,6 +33,11 @@ namespace transport_catalogue::service {
         return {};
     }
 
+    std::string GetStringSetting(const json::Dict& list, std::string_view setting) {
+        const auto it = list.find(setting);
+        return it != list.end() ? it->second.AsString() : std::string();
+    }
+
     svg::Color GetColor(const json::Node& color_node) {
         if (color_node.IsArray()) {
             const json::Array& props = color_node.AsArray();
@@ -52,18 +60,19 @@ namespace transport_catalogue::service {
         return {};
     }
 
-    svg::Color GetColorSetting(const json::Dict& list, const std::string& setting) {
-        if (list.count(setting) > 0) {
-            return GetColor(list.at(setting));
+    svg::Color GetColorSetting(const json::Dict& list, std::string_view setting) {
+        if (const auto it = list.find(setting); it != list.end()) {
+            return GetColor(it->second);
         }
         return {};
     }
 
-    std::vector<svg::Color> GetColorsVector(const json::Dict& list, const std::string& setting) {
-        if (list.count(setting) == 0) {
+    std::vector<svg::Color> GetColorsVector(const json::Dict& list, std::string_view setting) {
+        const auto it = list.find(setting);
+        if (it == list.end()) {
             return {};
         }
-        const json::Array& raw_colors = list.at(setting).AsArray();
+        const json::Array& raw_colors = it->second.AsArray();
 
         std::vector<svg::Color> result;
         result.reserve(raw_colors.size());
@@ -77,223 +86,992 @@ namespace transport_catalogue::service {
 
     RenderSettings ParseRenderSettings(const json::Dict& settings) {
         return {
-                GetDoubleSetting(settings, "width"s),
-                GetDoubleSetting(settings, "height"s),
+                GetDoubleSetting(settings, "width"sv),
+                GetDoubleSetting(settings, "height"sv),
 
-                GetDoubleSetting(settings, "padding"s),
+                GetDoubleSetting(settings, "padding"sv),
 
-                GetDoubleSetting(settings, "line_width"s),
-                GetDoubleSetting(settings, "stop_radius"s),
+                GetDoubleSetting(settings, "line_width"sv),
+                GetDoubleSetting(settings, "stop_radius"sv),
 
-                GetIntSetting(settings, "bus_label_font_size"s),
-                GetPointSetting(settings, "bus_label_offset"s),
+                GetIntSetting(settings, "bus_label_font_size"sv),
+                GetPointSetting(settings, "bus_label_offset"sv),
 
-                GetIntSetting(settings, "stop_label_font_size"s),
-                GetPointSetting(settings, "stop_label_offset"s),
+                GetIntSetting(settings, "stop_label_font_size"sv),
+                GetPointSetting(settings, "stop_label_offset"sv),
 
-                GetColorSetting(settings, "underlayer_color"s),
-                GetDoubleSetting(settings, "underlayer_width"s),
+                GetColorSetting(settings, "underlayer_color"sv),
+                GetDoubleSetting(settings, "underlayer_width"sv),
 
-                GetColorsVector(settings, "color_palette"s)
+                GetColorsVector(settings, "color_palette"sv)
         };
     }
 
     RouterSettings ParseRoutingSettings(const json::Dict& settings) {
         return {
-                GetIntSetting(settings, "bus_wait_time"s),
-                GetDoubleSetting(settings, "bus_velocity"s)
+                GetIntSetting(settings, "bus_wait_time"sv),
+                GetDoubleSetting(settings, "bus_velocity"sv)
         };
     }
 
-    JsonReader::JsonReader(TransportCatalogue& db) : db_(db), transport_router_(db) {}
-
-    void JsonReader::ReadJson(std::istream& in) {
-        json_raw_ = json::Load(in);
+    SerializationSettings ParseSerializationSettings(const json::Dict& settings) {
+        return {
+                settings.at("file"sv).AsString(),
+                GetStringSetting(settings, "flat_file"sv),
+                GetStringSetting(settings, "delta_file"sv)
+        };
     }
 
-    void JsonReader::FillCatalogue() {
-        if (!json_raw_.GetRoot().IsMap()) {
-            return;
+    /*
+     * Разбирает вход потоком событий. Остановки, расстояния и автобусы сразу становятся описаниями,
+     * запросы статистики - StatRequest, и только небольшие словари настроек собираются в узлы.
+     * Повторяющиеся ключи в настройках ловит TreeBuilder, в запросах и корне - сам обработчик
+     */
+    class JsonReader::InputHandler final : public json::EventHandler {
+    public:
+        explicit InputHandler(JsonReader& reader)
+            : reader_(reader) {
+            reader_.has_requests_ = false;
+            reader_.has_stat_requests_ = false;
+            reader_.input_strings_ = std::make_unique<StringPool>();
+            reader_.base_stops_.clear();
+            reader_.base_distances_.clear();
+            reader_.base_buses_.clear();
+            reader_.stat_requests_.clear();
+            reader_.render_settings_.reset();
+            reader_.routing_settings_.reset();
+            reader_.serialization_settings_.reset();
         }
-        const json::Dict& queries = json_raw_.GetRoot().AsMap();
-        if (queries.count("base_requests"s)) {
-            HandleBaseRequests(queries.at("base_requests"s).AsArray());
+
+        void OnNull() override {
+            BeginValue();
+            if (!Delegate(0, [](json::TreeBuilder& builder) { builder.OnNull(); })) {
+                AcceptScalar(ValueType::NONE);
+            }
         }
-        if (queries.count("render_settings"s)) {
-            map_renderer_.UpdateSettings(ParseRenderSettings(queries.at("render_settings"s).AsMap()));
+
+        void OnBool(bool value) override {
+            BeginValue();
+            if (!Delegate(0, [value](json::TreeBuilder& builder) { builder.OnBool(value); })
+                && AcceptScalar(ValueType::BOOL)) {
+                request_.is_roundtrip = value;
+            }
         }
-        if (queries.count("routing_settings"s)) {
-            transport_router_.UpdateSettings(
-                    ParseRoutingSettings(queries.at("routing_settings"s).AsMap()));
-            transport_router_.BuildGraph();
+
+        void OnInt(int value) override {
+            BeginValue();
+            if (Delegate(0, [value](json::TreeBuilder& builder) { builder.OnInt(value); })) {
+                return;
+            }
+            if (state_ == State::ROAD_DISTANCES) {
+                reader_.base_distances_.push_back({{}, road_destination_, value});
+            } else if (AcceptScalar(ValueType::INT)) {
+                if (field_ == ID) {
+                    request_.id = value;
+                } else if (field_ == COUNT) {
+                    request_.count = value;
+                } else {
+                    request_.numbers[field_ - LATITUDE] = value;
+                }
+            }
         }
-    }
 
-    void JsonReader::GetStats(std::ostream& out) const {
-        if (!json_raw_.GetRoot().IsMap()) {
-            return;
+        void OnDouble(double value) override {
+            BeginValue();
+            if (!Delegate(0, [value](json::TreeBuilder& builder) { builder.OnDouble(value); })
+                && AcceptScalar(ValueType::DOUBLE)) {
+                request_.numbers[field_ - LATITUDE] = value;
+            }
         }
-        const json::Dict& queries = json_raw_.GetRoot().AsMap();
-        if (queries.count("stat_requests"s) > 0) {
-            HandleStatRequests(queries.at("stat_requests"s).AsArray(), out);
+
+        void OnString(std::string_view value) override {
+            BeginValue();
+            if (Delegate(0, [value](json::TreeBuilder& builder) { builder.OnString(value); })) {
+                return;
+            }
+            if (state_ == State::BUS_STOPS) {
+                bus_stops_.push_back(Intern(value));
+            } else if (AcceptScalar(ValueType::STRING)) {
+                if (field_ == TYPE) {
+                    request_.is_bus = value == "Bus"sv;
+                    request_.stat_type = ParseStatType(value);
+                } else {
+                    request_.texts[field_ - NAME] = Intern(value);
+                }
+            }
         }
-    }
 
-    void JsonReader::HandleBaseRequests(const json::Array& requests) {
-        std::unordered_map<std::string_view, const json::Dict*> stop_to_distances;
-        std::deque<const json::Dict*> bus_requests;
+        void OnKey(std::string_view key) override {
+            if (Delegate(0, [key](json::TreeBuilder& builder) { builder.OnKey(key); })) {
+                return;
+            }
+            switch (state_) {
+                case State::SECTIONS:
+                    section_ = ParseSection(key);
+                    if (section_ != Section::OTHER) {
+                        MarkField(root_fields_, static_cast<unsigned>(section_), key);
+                    }
+                    return;
+                case State::BASE_REQUEST:
+                case State::STAT_REQUEST:
+                    field_ = ParseField(key);
+                    if (field_ != OTHER) {
+                        MarkField(request_.fields, field_, key);
+                    }
+                    return;
+                case State::ROAD_DISTANCES:
+                    road_destination_ = Intern(key);
+                    //Названия хранятся по одному разу, поэтому повтор ключа видно по адресу
+                    for (size_t i = request_.distances_begin; i < reader_.base_distances_.size(); ++i) {
+                        if (reader_.base_distances_[i].to.data() == road_destination_.data()) {
+                            ThrowDuplicateKey(key);
+                        }
+                    }
+                    return;
+                default:
+                    return;
+            }
+        }
 
-        for (const json::Node& node : requests) {
-            const json::Dict& request = node.AsMap();
+        void OnStartArray() override {
+            BeginValue();
+            if (Delegate(1, [](json::TreeBuilder& builder) { builder.OnStartArray(); })) {
+                return;
+            }
+            switch (state_) {
+                case State::ROOT:
+                    StartSkip(State::DONE, 1);
+                    return;
+                case State::SECTIONS:
+                    if (section_ == Section::STAT_REQUESTS) {
+                        reader_.has_stat_requests_ = true;
+                        state_ = State::STAT_REQUESTS;
+                    } else {
+                        state_ = State::BASE_REQUESTS;
+                    }
+                    return;
+                case State::BASE_REQUEST:
+                    if (field_ == STOPS) {
+                        state_ = State::BUS_STOPS;
+                        return;
+                    }
+                    SkipWrongValue();
+                    return;
+                case State::STAT_REQUEST:
+                case State::ROAD_DISTANCES:
+                case State::BUS_STOPS:
+                    SkipWrongValue();
+                    return;
+                default:
+                    ThrowUnexpectedValue();
+            }
+        }
 
-            if (request.at("type"s).AsString() == "Bus"s) {
-                bus_requests.push_back(&request);
-                continue;
+        void OnEndArray() override {
+            if (Delegate(-1, [](json::TreeBuilder& builder) { builder.OnEndArray(); })) {
+                return;
             }
+            //Закрылся список остановок автобуса, base_requests или stat_requests
+            state_ = state_ == State::BUS_STOPS ? State::BASE_REQUEST : State::SECTIONS;
+        }
 
-            std::string_view stop_name = request.at("name"s).AsString();
+        void OnStartDict() override {
+            BeginValue();
+            if (Delegate(1, [](json::TreeBuilder& builder) { builder.OnStartDict(); })) {
+                return;
+            }
+            switch (state_) {
+                case State::ROOT:
+                    reader_.has_requests_ = true;
+                    state_ = State::SECTIONS;
+                    return;
+                case State::BASE_REQUESTS:
+                    StartRequest(State::BASE_REQUEST);
+                    return;
+                case State::STAT_REQUESTS:
+                    StartRequest(State::STAT_REQUEST);
+                    return;
+                case State::BASE_REQUEST:
+                    if (field_ == ROAD_DISTANCES) {
+                        state_ = State::ROAD_DISTANCES;
+                        return;
+                    }
+                    SkipWrongValue();
+                    return;
+                case State::STAT_REQUEST:
+                case State::ROAD_DISTANCES:
+                case State::BUS_STOPS:
+                    SkipWrongValue();
+                    return;
+                default:
+                    ThrowUnexpectedValue();
+            }
+        }
 
-            // Остановки добавляем сразу, всё остальное копим
-            db_.AddStop(stop_name,
-                        request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble());
+        void OnEndDict() override {
+            if (Delegate(-1, [](json::TreeBuilder& builder) { builder.OnEndDict(); })) {
+                return;
+            }
+            switch (state_) {
+                case State::ROAD_DISTANCES:
+                    state_ = State::BASE_REQUEST;
+                    return;
+                case State::BASE_REQUEST:
+                    FinishBaseRequest();
+                    state_ = State::BASE_REQUESTS;
+                    return;
+                case State::STAT_REQUEST:
+                    FinishStatRequest();
+                    state_ = State::STAT_REQUESTS;
+                    return;
+                default:
+                    state_ = State::DONE;
+                    return;
+            }
+        }
 
-            if (request.count("road_distances"s)) {
-                stop_to_distances[stop_name] = &request.at("road_distances"s).AsMap();
+        // Оставляет каждой остановке расстояния из последнего описания, где они были
+        void Finish() {
+            if (distance_lists_ == last_distances_.size()) {
+                return;
             }
+            std::vector<DistanceDescription>& distances = reader_.base_distances_;
+            size_t kept = 0;
+            for (size_t i = 0; i < distances.size(); ++i) {
+                const auto [begin, end] = last_distances_.at(distances[i].from);
+                if (i >= begin && i < end) {
+                    distances[kept++] = distances[i];
+                }
+            }
+            distances.resize(kept);
         }
 
-        InsertDistances(stop_to_distances);
-        BusAddRequests(bus_requests);
-    }
+    private:
+        enum class State {
+            ROOT,
+            SECTIONS,        // ключи корневого словаря
+            SKIP,            // значение, которое не нужно
+            SETTINGS,        // значение, которое собирается в узел
+            BASE_REQUESTS,
+            BASE_REQUEST,
+            ROAD_DISTANCES,
+            BUS_STOPS,
+            STAT_REQUESTS,
+            STAT_REQUEST,
+            DONE,
+        };
 
-    void JsonReader::InsertDistances(const std::unordered_map<std::string_view, const json::Dict*>& requests) {
-        for (const auto& [name, dists_ptr] : requests) {
-            for (const auto& [dest_name, destination] : *dists_ptr) {
-                db_.AddDistance(name, dest_name, destination.AsInt());
-            }
+        enum class Section {
+            BASE_REQUESTS,
+            STAT_REQUESTS,
+            RENDER_SETTINGS,
+            ROUTING_SETTINGS,
+            SERIALIZATION_SETTINGS,
+            OTHER,
+        };
+
+        // Известные поля запросов в порядке FIELD_NAMES. Номер поля - номер бита в Request::fields
+        enum Field : unsigned {
+            TYPE,
+            ID,
+            NAME,
+            FROM,
+            TO,
+            LATITUDE,
+            LONGITUDE,
+            MIN_LATITUDE,
+            MIN_LONGITUDE,
+            MAX_LATITUDE,
+            MAX_LONGITUDE,
+            COUNT,
+            ROAD_DISTANCES,
+            STOPS,
+            IS_ROUNDTRIP,
+            OTHER,
+        };
+
+        static constexpr std::string_view FIELD_NAMES[] = {
+                "type"sv, "id"sv, "name"sv, "from"sv, "to"sv,
+                "latitude"sv, "longitude"sv, "min_latitude"sv, "min_longitude"sv, "max_latitude"sv, "max_longitude"sv,
+                "count"sv, "road_distances"sv, "stops"sv, "is_roundtrip"sv,
+        };
+
+        enum class ValueType {
+            NONE,
+            BOOL,
+            INT,
+            DOUBLE,
+            STRING,
+        };
+
+        // Поля текущего запроса
+        struct Request {
+            unsigned fields = 0;
+            // Поля неподходящего типа. Ошибкой они станут, только если запрос такого типа их читает
+            unsigned wrong_fields = 0;
+            // Расстояние не целое или название остановки автобуса не строка
+            bool has_wrong_distance = false;
+            bool has_wrong_stop = false;
+            bool is_bus = false;
+            StatRequest::Type stat_type = StatRequest::Type::UNKNOWN;
+            std::string_view texts[TO - NAME + 1];
+            double numbers[MAX_LONGITUDE - LATITUDE + 1] = {};
+            int id = 0;
+            int count = 0;
+            bool is_roundtrip = false;
+            size_t distances_begin = 0;
+        };
+
+        JsonReader& reader_;
+        State state_ = State::ROOT;
+        Section section_ = Section::OTHER;
+        Field field_ = OTHER;
+        unsigned root_fields_ = 0;
+        Request request_;
+        std::string_view road_destination_;
+        // Остановки текущего автобуса
+        std::vector<std::string_view> bus_stops_;
+        std::unordered_set<std::string_view> names_;
+
+        // Полуинтервал последнего списка расстояний каждой остановки в base_distances_
+        std::unordered_map<std::string_view, std::pair<size_t, size_t>> last_distances_;
+        size_t distance_lists_ = 0;
+
+        // Пропускаемое значение или значение настроек: глубина вложенности и куда вернуться после него
+        int nested_depth_ = 0;
+        State nested_return_ = State::DONE;
+        json::TreeBuilder settings_;
+        std::optional<json::Node>* settings_target_ = nullptr;
+
+        [[noreturn]] static void ThrowWrongType(std::string_view expected) {
+            throw std::logic_error("Failed attempt to parse node as "s + std::string(expected) + "!"s);
         }
-    }
 
-    void JsonReader::BusAddRequests(const std::deque<const json::Dict*>& requests) {
-        for (const json::Dict* request : requests) {
-            std::string_view bus_name = request->at("name"s).AsString();
+        [[noreturn]] void ThrowUnexpectedValue() const {
+            ThrowWrongType(state_ == State::SECTIONS ? "array"sv : "map"sv);
+        }
 
-            const json::Array& stops_array = request->at("stops"s).AsArray();
-            std::vector<std::string_view> stops;
-            stops.reserve(stops_array.size());
-            for (const json::Node& stop : stops_array) {
-                stops.emplace_back(stop.AsString());
+        [[noreturn]] static void ThrowDuplicateKey(std::string_view key) {
+            throw json::ParsingError("Failed attempt to parse Dictionary! Duplicate key \""s
+                                     + std::string(key) + "\" have been found"s);
+        }
+
+        static void MarkField(unsigned& fields, unsigned field, std::string_view key) {
+            const unsigned bit = 1u << field;
+            if (fields & bit) {
+                ThrowDuplicateKey(key);
             }
+            fields |= bit;
+        }
 
-            bool is_roundtrip = request->at("is_roundtrip"s).AsBool();
-            db_.AddBus(bus_name, stops, is_roundtrip ? RouteType::ROUND_TRIP : RouteType::ONE_WAY);
+        static Section ParseSection(std::string_view key) {
+            if (key == "base_requests"sv) {
+                return Section::BASE_REQUESTS;
+            } else if (key == "stat_requests"sv) {
+                return Section::STAT_REQUESTS;
+            } else if (key == "render_settings"sv) {
+                return Section::RENDER_SETTINGS;
+            } else if (key == "routing_settings"sv) {
+                return Section::ROUTING_SETTINGS;
+            } else if (key == "serialization_settings"sv) {
+                return Section::SERIALIZATION_SETTINGS;
+            }
+            return Section::OTHER;
         }
-    }
 
-    void JsonReader::HandleStatRequests(const json::Array& requests, std::ostream& out) const {
-        json::Builder response;
-        response.StartArray();
-        for (const json::Node& request_node : requests) {
-            const json::Dict& request = request_node.AsMap();
+        static Field ParseField(std::string_view key) {
+            const auto it = std::find(std::begin(FIELD_NAMES), std::end(FIELD_NAMES), key);
+            return static_cast<Field>(it - std::begin(FIELD_NAMES));
+        }
 
-            std::string_view type = request.at("type"s).AsString();
-            int request_id = request.at("id"s).AsInt();
+        static StatRequest::Type ParseStatType(std::string_view type) {
             if (type == "Bus"sv) {
-                response.Value(GetBusStat(request.at("name"s).AsString(), request_id));
-                continue;
+                return StatRequest::Type::BUS;
             } else if (type == "Stop"sv) {
-                response.Value(GetStopStat(request.at("name"s).AsString(), request_id));
-                continue;
+                return StatRequest::Type::STOP;
             } else if (type == "Map"sv) {
-                response.Value(RenderMap(request_id));
-                continue;
+                return StatRequest::Type::MAP;
             } else if (type == "Route"sv) {
-                std::string_view from = request.at("from"s).AsString();
-                std::string_view to = request.at("to"s).AsString();
-                response.Value(BuildRoute(request_id, from, to));
+                return StatRequest::Type::ROUTE;
+            } else if (type == "NearestStops"sv) {
+                return StatRequest::Type::NEAREST_STOPS;
+            } else if (type == "StopsInArea"sv) {
+                return StatRequest::Type::STOPS_IN_AREA;
+            }
+            return StatRequest::Type::UNKNOWN;
+        }
+
+        static ValueType GetValueType(Field field) {
+            if (field == ID || field == COUNT) {
+                return ValueType::INT;
+            } else if (field <= TO) {
+                return ValueType::STRING;
+            } else if (field == IS_ROUNDTRIP) {
+                return ValueType::BOOL;
+            }
+            return field <= MAX_LONGITUDE ? ValueType::DOUBLE : ValueType::NONE;
+        }
+
+        static std::string_view GetTypeName(Field field) {
+            switch (field) {
+                case ROAD_DISTANCES: return "map"sv;
+                case STOPS: return "array"sv;
+                default: break;
+            }
+            switch (GetValueType(field)) {
+                case ValueType::STRING: return "string"sv;
+                case ValueType::INT: return "int"sv;
+                case ValueType::BOOL: return "bool"sv;
+                default: return "double"sv;
+            }
+        }
+
+        std::string_view Text(Field field) const {
+            return request_.texts[field - NAME];
+        }
+
+        double Number(Field field) const {
+            return request_.numbers[field - LATITUDE];
+        }
+
+        std::string_view Intern(std::string_view name) {
+            if (const auto it = names_.find(name); it != names_.end()) {
+                return *it;
             }
+            return *names_.insert(reader_.input_strings_->Add(name)).first;
+        }
+
+        // Настройки собираются в узел, неизвестные разделы и поля пропускаются целиком
+        void BeginValue() {
+            if (state_ == State::SECTIONS) {
+                if (section_ == Section::RENDER_SETTINGS) {
+                    StartSettings(&reader_.render_settings_);
+                } else if (section_ == Section::ROUTING_SETTINGS) {
+                    StartSettings(&reader_.routing_settings_);
+                } else if (section_ == Section::SERIALIZATION_SETTINGS) {
+                    StartSettings(&reader_.serialization_settings_);
+                } else if (section_ == Section::OTHER) {
+                    StartSkip(State::SECTIONS, 0);
+                }
+            } else if ((state_ == State::BASE_REQUEST || state_ == State::STAT_REQUEST) && field_ == OTHER) {
+                StartSkip(state_, 0);
+            }
+        }
+
+        void StartSettings(std::optional<json::Node>* target) {
+            settings_target_ = target;
+            nested_return_ = State::SECTIONS;
+            nested_depth_ = 0;
+            state_ = State::SETTINGS;
+        }
+
+        void StartSkip(State return_state, int depth) {
+            nested_return_ = return_state;
+            nested_depth_ = depth;
+            state_ = State::SKIP;
+        }
+
+        // Отдаёт событие настройкам или пропускает его. Возвращает false, если событие для запросов
+        template <typename Send>
+        bool Delegate(int depth_change, Send send) {
+            if (state_ != State::SKIP && state_ != State::SETTINGS) {
+                return false;
+            }
+            if (state_ == State::SETTINGS) {
+                send(settings_);
+            }
+            nested_depth_ += depth_change;
+            if (nested_depth_ == 0) {
+                if (state_ == State::SETTINGS) {
+                    *settings_target_ = settings_.Extract();
+                }
+                state_ = nested_return_;
+            }
+            return true;
+        }
+
+        // Проверяет, что скаляр стоит на месте поля запроса подходящего типа. Неподходящий запоминается,
+        // как и контейнер в SkipWrongValue: дерево json'а тоже проверяло тип, только когда поле читали.
+        // Скаляр вместо корневого словаря означает, что запросов нет
+        bool AcceptScalar(ValueType type) {
+            if (state_ == State::ROOT) {
+                state_ = State::DONE;
+                return false;
+            }
+            if (state_ == State::ROAD_DISTANCES || state_ == State::BUS_STOPS) {
+                MarkWrongValue();
+                return false;
+            }
+            if (state_ != State::BASE_REQUEST && state_ != State::STAT_REQUEST) {
+                ThrowUnexpectedValue();
+            }
+            const ValueType expected = GetValueType(field_);
+            if (type == ValueType::NONE
+                || (expected != type && !(expected == ValueType::DOUBLE && type == ValueType::INT))) {
+                MarkWrongValue();
+                return false;
+            }
+            return true;
+        }
+
+        void MarkWrongValue() {
+            if (state_ == State::ROAD_DISTANCES) {
+                request_.has_wrong_distance = true;
+            } else if (state_ == State::BUS_STOPS) {
+                request_.has_wrong_stop = true;
+            } else {
+                request_.wrong_fields |= 1u << field_;
+            }
+        }
+
+        // Контейнер на месте поля, расстояния или остановки автобуса пропускается целиком
+        void SkipWrongValue() {
+            MarkWrongValue();
+            StartSkip(state_, 1);
         }
-        json::Print(json::Document{std::move(response.EndArray().Build().AsArray())}, out);
+
+        void StartRequest(State state) {
+            request_ = Request{};
+            request_.distances_begin = reader_.base_distances_.size();
+            bus_stops_.clear();
+            field_ = OTHER;
+            state_ = state;
+        }
+
+        // Поля, которые запрос читает: они должны быть и иметь нужный тип
+        void Require(std::initializer_list<Field> fields) const {
+            for (Field field : fields) {
+                if ((request_.fields & (1u << field)) == 0) {
+                    throw std::out_of_range("Request has no \""s + std::string(FIELD_NAMES[field]) + "\" field"s);
+                }
+                if (request_.wrong_fields & (1u << field)) {
+                    ThrowWrongType(GetTypeName(field));
+                }
+            }
+        }
+
+        void FinishBaseRequest() {
+            Require({TYPE});
+            std::vector<DistanceDescription>& distances = reader_.base_distances_;
+            if (request_.is_bus) {
+                Require({NAME, STOPS, IS_ROUNDTRIP});
+                if (request_.has_wrong_stop) {
+                    ThrowWrongType("string"sv);
+                }
+                distances.resize(request_.distances_begin);
+                reader_.base_buses_.push_back({Text(NAME), bus_stops_,
+                                               request_.is_roundtrip ? RouteType::ROUND_TRIP : RouteType::ONE_WAY});
+                return;
+            }
+
+            Require({NAME, LATITUDE, LONGITUDE});
+            const std::string_view name = Text(NAME);
+            reader_.base_stops_.push_back({name, {Number(LATITUDE), Number(LONGITUDE)}});
+            if (request_.fields & (1u << ROAD_DISTANCES)) {
+                Require({ROAD_DISTANCES});
+                if (request_.has_wrong_distance) {
+                    ThrowWrongType("int"sv);
+                }
+                for (size_t i = request_.distances_begin; i < distances.size(); ++i) {
+                    distances[i].from = name;
+                }
+                last_distances_[name] = {request_.distances_begin, distances.size()};
+                ++distance_lists_;
+            }
+        }
+
+        void FinishStatRequest() {
+            Require({TYPE, ID});
+            StatRequest& request = reader_.stat_requests_.emplace_back();
+            request.type = request_.stat_type;
+            request.id = request_.id;
+            switch (request.type) {
+                case StatRequest::Type::BUS:
+                case StatRequest::Type::STOP:
+                    Require({NAME});
+                    request.name = Text(NAME);
+                    break;
+                case StatRequest::Type::ROUTE:
+                    Require({FROM, TO});
+                    request.name = Text(FROM);
+                    request.to = Text(TO);
+                    break;
+                case StatRequest::Type::NEAREST_STOPS:
+                    Require({LATITUDE, LONGITUDE, COUNT});
+                    request.point = {Number(LATITUDE), Number(LONGITUDE)};
+                    request.count = request_.count;
+                    break;
+                case StatRequest::Type::STOPS_IN_AREA:
+                    Require({MIN_LATITUDE, MIN_LONGITUDE, MAX_LATITUDE, MAX_LONGITUDE});
+                    request.point = {Number(MIN_LATITUDE), Number(MIN_LONGITUDE)};
+                    request.max = {Number(MAX_LATITUDE), Number(MAX_LONGITUDE)};
+                    break;
+                default:
+                    break;
+            }
+        }
+    };
+
+    JsonReader::JsonReader(CataloguePublisher& publisher)
+        : publisher_(publisher)
+        , db_(CatalogueBuilder().Build())
+        , transport_router_(std::make_unique<TransportRouter>(*db_)) {
     }
 
-    json::Dict JsonReader::GetBusStat(std::string_view bus_name, int request_id) const {
-        if (!db_.IsBusExists(bus_name)) {
-            return json::Dict {
-                {"request_id"s, request_id},
-                {"error_message"s, "not found"s}
-            };
+    void JsonReader::ReadJson(std::istream& in) {
+        const std::string text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        InputHandler handler(*this);
+        json::Parse(text, handler);
+        handler.Finish();
+    }
+
+    void JsonReader::ReadJsonFile(const std::string& path) {
+        InputHandler handler(*this);
+        json::ParseFile(path, handler);
+        handler.Finish();
+    }
+
+    void JsonReader::FillCatalogue(bool build_router) {
+        if (!has_requests_) {
+            return;
         }
-        RouteInfo stat = db_.GetRouteInfo(bus_name);
-        return json::Dict {
-                {"request_id"s, request_id},
-                {"curvature"s, stat.curvature},
-                {"route_length"s, stat.real_length},
-                {"stop_count"s, (int) stat.total_stops},
-                {"unique_stop_count"s, (int) stat.uniq_stops},
-        };
+        CatalogueBuilder builder;
+        HandleBaseRequests(builder.GetCatalogue());
+        db_ = builder.Build();
+        transport_router_ = std::make_unique<TransportRouter>(*db_);
+        PrepareStopStats();
+        if (render_settings_) {
+            map_renderer_.UpdateSettings(ParseRenderSettings(render_settings_->AsMap()));
+        }
+        if (build_router && routing_settings_) {
+            transport_router_->UpdateSettings(ParseRoutingSettings(routing_settings_->AsMap()));
+            transport_router_->BuildGraph();
+        }
+        publisher_.Publish(db_);
     }
 
-    json::Dict JsonReader::GetStopStat(std::string_view stop_name, int request_id) const {
-        if (!db_.IsStopExists(stop_name)) {
-            return json::Dict {
-                {"request_id"s, request_id},
-                {"error_message"s, "not found"s}
-            };
+    void JsonReader::GetStats(std::ostream& out) const {
+        if (has_stat_requests_) {
+            //Пока в publisher ничего не опубликовано, отвечаем по своему каталогу
+            const CatalogueSnapshot db = publisher_.Pin();
+            HandleStatRequests(out, db ? *db : *db_);
+        }
+    }
+
+    bool JsonReader::SaveBase() const {
+        std::optional<SerializationSettings> settings = GetSerializationSettings();
+        if (!settings) {
+            return false;
+        }
+        std::ofstream out(settings->file, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+        SerializeBase(*db_, map_renderer_, *transport_router_, out);
+        if (!out) {
+            return false;
+        }
+
+        if (!settings->flat_file.empty()) {
+            std::ofstream flat_out(settings->flat_file, std::ios::binary);
+            if (!flat_out) {
+                return false;
+            }
+            WriteFlatCatalogue(*db_, flat_out);
+            return static_cast<bool>(flat_out);
+        }
+        return true;
+    }
+
+    bool JsonReader::LoadBase() {
+        std::optional<SerializationSettings> settings = GetSerializationSettings();
+        if (!settings) {
+            return false;
+        }
+        //Справочным запросам не нужны ни маршрутизатор, ни отрисовка, так что полную базу можно не читать.
+        //Плоская база обновлений не знает, поэтому при обновлении её не используем
+        if (!settings->flat_file.empty() && settings->delta_file.empty() && HasOnlyCatalogueRequests()) {
+            try {
+                flat_db_ = std::make_unique<FlatCatalogue>(settings->flat_file);
+                return true;
+            } catch (const std::runtime_error&) {
+                flat_db_.reset();
+            }
+        }
+
+        std::ifstream in(settings->file, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        //Маршрутизатор восстанавливается вместе с каталогом. Build переносит каталог в снимок, не перемещая его,
+        //так что ссылка маршрутизатора остаётся верной
+        CatalogueBuilder builder;
+        TransportCatalogue& db = builder.GetCatalogue();
+        auto transport_router = std::make_unique<TransportRouter>(db);
+        if (!settings->delta_file.empty()) {
+            std::ifstream delta_in(settings->delta_file, std::ios::binary);
+            if (!delta_in) {
+                return false;
+            }
+            if (!DeserializeBase(in, delta_in, db, map_renderer_, *transport_router)) {
+                return false;
+            }
+        } else if (!DeserializeBase(in, db, map_renderer_, *transport_router)) {
+            return false;
+        }
+        db_ = builder.Build();
+        transport_router_ = std::move(transport_router);
+        publisher_.Publish(db_);
+
+        PrepareStopStats();
+
+        //Запросы могут переопределить настройки отрисовки. Если они отличаются от сохранённых, готовая карта не подойдёт
+        if (render_settings_) {
+            map_renderer_.UpdateSettings(ParseRenderSettings(render_settings_->AsMap()));
+        }
+        return true;
+    }
+
+    bool JsonReader::SaveDelta(const TransportCatalogue& old_db) const {
+        std::optional<SerializationSettings> settings = GetSerializationSettings();
+        if (!settings || settings->delta_file.empty()) {
+            return false;
+        }
+        std::ofstream out(settings->delta_file, std::ios::binary);
+        if (!out) {
+            return false;
         }
-        const std::set<std::string_view>& buses = db_.GetStopBuses(stop_name);
+        SerializeDelta(old_db, *db_, out);
+        return static_cast<bool>(out);
+    }
 
-        json::Builder response;
+    bool JsonReader::HasOnlyCatalogueRequests() const {
+        return std::all_of(stat_requests_.begin(), stat_requests_.end(), [](const StatRequest& request) {
+            return request.type == StatRequest::Type::BUS || request.type == StatRequest::Type::STOP;
+        });
+    }
+
+    std::optional<SerializationSettings> JsonReader::GetSerializationSettings() const {
+        if (!serialization_settings_) {
+            return std::nullopt;
+        }
+        return ParseSerializationSettings(serialization_settings_->AsMap());
+    }
+
+    void JsonReader::PrepareStopStats() {
+        stop_buses_json_.clear();
+        stop_buses_json_.reserve(db_->GetStopCount());
+        std::ostringstream out;
+        for (StopId stop = 0; stop < db_->GetStopCount(); ++stop) {
+            out.str({});
+            json::StreamBuilder buses(out);
+            buses.StartArray();
+            for (BusId bus : db_->GetStopBuses(stop)) {
+                buses.Value(db_->GetBusName(bus));
+            }
+            buses.EndArray().Finish();
+            stop_buses_json_.push_back(out.str());
+        }
+    }
+
+    void JsonReader::HandleBaseRequests(TransportCatalogue& db) {
+        db.AddBulk(base_stops_, base_distances_, base_buses_);
+        //Каталог хранит свои копии, описания больше не нужны
+        base_stops_ = {};
+        base_distances_ = {};
+        base_buses_ = {};
+    }
+
+    void JsonReader::HandleStatRequests(std::ostream& out, const TransportCatalogue& db) const {
+        //Карта от запроса к запросу не меняется. Если запросов несколько, её текст в JSON собирается один раз
+        const bool is_map_repeated = std::count_if(stat_requests_.begin(), stat_requests_.end(),
+                                                   [](const StatRequest& request) {
+                                                       return request.type == StatRequest::Type::MAP;
+                                                   }) > 1;
+        std::string map_json;
+
+        json::StreamBuilder response(out);
+        response.StartArray();
+        for (const StatRequest& request : stat_requests_) {
+            switch (request.type) {
+                case StatRequest::Type::BUS:
+                    if (flat_db_) {
+                        PrintBusStat(response, *flat_db_, request.name, request.id);
+                    } else {
+                        PrintBusStat(response, db, request.name, request.id);
+                    }
+                    break;
+                case StatRequest::Type::STOP:
+                    if (flat_db_) {
+                        PrintStopStat(response, *flat_db_, request.name, request.id);
+                    } else {
+                        PrintStopStat(response, db, request.name, request.id);
+                    }
+                    break;
+                case StatRequest::Type::NEAREST_STOPS:
+                    PrintNearestStops(response, db, request);
+                    break;
+                case StatRequest::Type::STOPS_IN_AREA:
+                    PrintStopsInArea(response, db, request);
+                    break;
+                case StatRequest::Type::MAP:
+                    PrintMap(response, request.id, is_map_repeated ? &map_json : nullptr);
+                    break;
+                case StatRequest::Type::ROUTE:
+                    PrintRoute(response, request.id, request.name, request.to);
+                    break;
+                default:
+                    break;
+            }
+        }
+        response.EndArray().Finish();
+    }
+
+    //Ключи ответов выводятся по алфавиту, в том же порядке, в каком их печатал json::Dict
+
+    template <typename Catalogue>
+    void JsonReader::PrintBusStat(json::StreamBuilder& response, const Catalogue& db, std::string_view bus_name,
+                                  int request_id) const {
+        //Каталог в памяти ищет автобус по названию один раз
+        std::optional<RouteInfo> found_stat;
+        if constexpr (std::is_same_v<Catalogue, TransportCatalogue>) {
+            if (std::optional<BusId> bus = db.FindBus(bus_name)) {
+                found_stat = db.GetRouteInfo(*bus);
+            }
+        } else if (db.IsBusExists(bus_name)) {
+            found_stat = db.GetRouteInfo(bus_name);
+        }
+        if (!found_stat) {
+            PrintNotFound(response, request_id);
+            return;
+        }
+        const RouteInfo& stat = *found_stat;
         response.StartDict()
-            .Key("request_id"s).Value(request_id)
-            .Key("buses"s).StartArray();
+            .Key("curvature"sv).Value(stat.curvature)
+            .Key("request_id"sv).Value(request_id)
+            .Key("route_length"sv).Value(stat.real_length)
+            .Key("stop_count"sv).Value(static_cast<int>(stat.total_stops))
+            .Key("unique_stop_count"sv).Value(static_cast<int>(stat.uniq_stops))
+            .EndDict();
+    }
 
-        for (std::string_view bus : buses) {
-            response.Value(std::string(bus));
+    template <typename Catalogue>
+    void JsonReader::PrintStopStat(json::StreamBuilder& response, const Catalogue& db, std::string_view stop_name,
+                                   int request_id) const {
+        if constexpr (std::is_same_v<Catalogue, TransportCatalogue>) {
+            //У собранного здесь каталога массив автобусов уже сериализован, его вставляем как есть
+            if (std::optional<StopId> stop = db.FindStop(stop_name)) {
+                if (&db == db_.get()) {
+                    response.StartDict().Key("buses"sv).Value(json::RawJson{stop_buses_json_[*stop]});
+                } else {
+                    response.StartDict().Key("buses"sv).StartArray();
+                    for (BusId bus : db.GetStopBuses(*stop)) {
+                        response.Value(db.GetBusName(bus));
+                    }
+                    response.EndArray();
+                }
+                response.Key("request_id"sv).Value(request_id).EndDict();
+                return;
+            }
+        } else if (db.IsStopExists(stop_name)) {
+            response.StartDict().Key("buses"sv).StartArray();
+            for (std::string_view bus : db.GetStopBuses(stop_name)) {
+                response.Value(bus);
+            }
+            response.EndArray()
+                .Key("request_id"sv).Value(request_id)
+                .EndDict();
+            return;
         }
+        PrintNotFound(response, request_id);
+    }
+
+    void JsonReader::PrintNearestStops(json::StreamBuilder& response, const TransportCatalogue& db,
+                                       const StatRequest& request) const {
+        const geo::Coordinates point = request.point;
 
-        return response.EndArray().EndDict().Build().AsMap();
+        response.StartDict()
+            .Key("request_id"sv).Value(request.id)
+            .Key("stops"sv).StartArray();
+        for (StopId stop : db.FindNearestStops(point, std::max(request.count, 0))) {
+            response.StartDict()
+                .Key("distance"sv).Value(geo::ComputeDistance(point, db.GetStopCoords(stop)))
+                .Key("name"sv).Value(db.GetStopName(stop))
+                .EndDict();
+        }
+        response.EndArray().EndDict();
     }
 
-    json::Dict JsonReader::RenderMap(int request_id) const {
-        std::ostringstream oss;
-        map_renderer_.Render(db_.GetBuses(), oss);
-        return {
-                {"map"s, oss.str()},
-                {"request_id"s, request_id}
+    void JsonReader::PrintStopsInArea(json::StreamBuilder& response, const TransportCatalogue& db,
+                                      const StatRequest& request) const {
+        //Остановки отдаём по названию, как и автобусы в ответе Stop
+        std::vector<StopId> stops = db.FindStopsInArea(request.point, request.max);
+        std::sort(stops.begin(), stops.end(), [&db](StopId lhs, StopId rhs) {
+            return db.GetStopName(lhs) < db.GetStopName(rhs);
+        });
+
+        response.StartDict()
+            .Key("request_id"sv).Value(request.id)
+            .Key("stops"sv).StartArray();
+        for (StopId stop : stops) {
+            response.Value(db.GetStopName(stop));
+        }
+        response.EndArray().EndDict();
+    }
+
+    void JsonReader::PrintMap(json::StreamBuilder& response, int request_id, std::string* map_json) const {
+        auto render = [this](std::ostream& out) {
+            map_renderer_.Render(*db_, out);
         };
+        auto map = response.StartDict().Key("map"sv);
+        if (map_json == nullptr) {
+            //SVG экранируется по мере отрисовки прямо в вывод
+            map.StringValueFrom(render);
+        } else {
+            if (map_json->empty()) {
+                json::Writer(*map_json).WriteStringFrom(render);
+            }
+            map.Value(json::RawJson{*map_json});
+        }
+        response.Key("request_id"sv).Value(request_id).EndDict();
     }
 
-    json::Dict JsonReader::BuildRoute(int request_id, std::string_view from, std::string_view to) const {
-        std::optional<Route> route = transport_router_.GetRoute(from, to);
+    void JsonReader::PrintRoute(json::StreamBuilder& response, int request_id, std::string_view from,
+                                std::string_view to) const {
+        std::optional<Route> route = transport_router_->GetRoute(from, to);
         if (!route) {
-            return {
-                    {"request_id"s, request_id},
-                    {"error_message"s, "not found"s}
-            };
+            PrintNotFound(response, request_id);
+            return;
         }
 
-        json::Builder response;
-        response.StartDict().Key("request_id"s).Value(request_id)
-            .Key("total_time").Value(route->total_time)
-            .Key("items"s).StartArray();
-
+        response.StartDict().Key("items"sv).StartArray();
         for (const EdgeInfo& interval : route->intervals) {
-            response.StartDict()
-            .Key("time"s).Value(interval.duration);
             if (!interval.is_waiting_edge) {
-                response
-                .Key("type"s).Value("Bus"s)
-                .Key("bus"s).Value(interval.current_route->name)
-                .Key("span_count"s).Value(static_cast<int>(interval.span_count));
+                response.StartDict()
+                    .Key("bus"sv).Value(db_->GetBusName(interval.bus))
+                    .Key("span_count"sv).Value(static_cast<int>(interval.span_count))
+                    .Key("time"sv).Value(interval.duration)
+                    .Key("type"sv).Value("Bus"sv)
+                    .EndDict();
             } else {
-                response
-                .Key("type"s).Value("Wait"s)
-                .Key("stop_name"s).Value(interval.destination_stop->name);
+                response.StartDict()
+                    .Key("stop_name"sv).Value(db_->GetStopName(interval.stop))
+                    .Key("time"sv).Value(interval.duration)
+                    .Key("type"sv).Value("Wait"sv)
+                    .EndDict();
             }
-            response.EndDict();
         }
+        response.EndArray()
+            .Key("request_id"sv).Value(request_id)
+            .Key("total_time"sv).Value(route->total_time)
+            .EndDict();
+    }
 
-        return response.EndArray().EndDict().Build().AsMap();
+    void JsonReader::PrintNotFound(json::StreamBuilder& response, int request_id) {
+        response.StartDict()
+            .Key("error_message"sv).Value("not found"sv)
+            .Key("request_id"sv).Value(request_id)
+            .EndDict();
     }
 
 
@@ -2,45 +2,130 @@
 
 #include <iostream>
 #include <string_view>
+#include <optional>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "json/json.h"
+#include "json/json_builder/json_stream_builder.h"
 #include "transport_catalogue/transport_catalogue.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+#include "transport_catalogue/flat_catalogue.h"
+#include "transport_catalogue/string_pool.h"
 #include "service/map_renderer/map_renderer.h"
 #include "service/transport_router/transport_router.h"
+#include "service/serialization/serialization.h"
 
 namespace transport_catalogue::service {
 
+    /*
+     * Каталог собирается в CatalogueBuilder и публикуется в publisher. Запросы к каталогу
+     * отвечаются по снимку, закреплённому в начале GetStats, так что каталог можно подменить, не дожидаясь их.
+     * Маршрутизатор, отрисованная карта и готовые ответы Stop построены по каталогу, который собрал
+     * этот JsonReader: Route и Map отвечаются по нему, даже если в publisher уже другой снимок
+     */
     class JsonReader {
     public:
-        JsonReader(TransportCatalogue& db);
+        JsonReader(CataloguePublisher& publisher);
 
-        // Читает из потока json и сохраняет его
+        // Читает из потока json и сохраняет описания базы, запросы и настройки. Дерево json целиком не строится
         void ReadJson(std::istream& in);
+        // Читает json из файла path, отображая его в память
+        void ReadJsonFile(const std::string& path);
 
-        // Заполняет каталог из сохранённого json'а
-        void FillCatalogue();
+        // Собирает и публикует каталог из сохранённого json'а. Граф маршрутизатора строится, только если build_router
+        void FillCatalogue(bool build_router = true);
 
         // Обрабатывает запросы из сохранённого json'а и выводит результат в поток out
         void GetStats(std::ostream& out) const;
 
+        // Сохраняет заполненный каталог в файл, указанный в serialization_settings
+        bool SaveBase() const;
+
+        // Собирает и публикует каталог из файла, указанного в serialization_settings.
+        // Если все запросы справочные (Bus и Stop) и есть плоская база, отображает в память её
+        bool LoadBase();
+
+        // Сохраняет в delta_file из serialization_settings обновление от каталога old_db к текущему
+        bool SaveDelta(const TransportCatalogue& old_db) const;
+
     private:
-        TransportCatalogue& db_;
+        class InputHandler;
+
+        // Запрос статистики, сохранённый без узлов json
+        struct StatRequest {
+            enum class Type : uint8_t {
+                BUS,
+                STOP,
+                MAP,
+                ROUTE,
+                NEAREST_STOPS,
+                STOPS_IN_AREA,
+                UNKNOWN,
+            };
+
+            Type type = Type::UNKNOWN;
+            int id = 0;
+            int count = 0;             // NearestStops
+            std::string_view name;     // Bus и Stop; откуда - для Route
+            std::string_view to;       // Route
+            geo::Coordinates point;    // NearestStops; нижний угол для StopsInArea
+            geo::Coordinates max;      // верхний угол для StopsInArea
+        };
+
+        CataloguePublisher& publisher_;
+        // Последний собранный каталог, пока ничего не собрано - пустой
+        CatalogueSnapshot db_;
         MapRenderer map_renderer_;
-        TransportRouter transport_router_;
+        // Ссылается на *db_
+        std::unique_ptr<TransportRouter> transport_router_;
+
+        // Корень входного json'а - словарь
+        bool has_requests_ = false;
+        bool has_stat_requests_ = false;
+        // Строки описаний и запросов, одинаковые названия хранятся один раз
+        std::unique_ptr<StringPool> input_strings_;
+        // Описания базы ждут FillCatalogue и после загрузки освобождаются
+        std::vector<StopDescription> base_stops_;
+        std::vector<DistanceDescription> base_distances_;
+        std::vector<BusDescription> base_buses_;
+        std::vector<StatRequest> stat_requests_;
+        std::optional<json::Node> render_settings_;
+        std::optional<json::Node> routing_settings_;
+        std::optional<json::Node> serialization_settings_;
+
+        std::unique_ptr<FlatCatalogue> flat_db_;
+
+        // Готовые JSON-массивы автобусов для ответов Stop, индекс - StopId
+        std::vector<std::string> stop_buses_json_;
 
-        json::Document json_raw_;
+        std::optional<SerializationSettings> GetSerializationSettings() const;
+        // Собирает stop_buses_json_ по db_
+        void PrepareStopStats();
+        bool HasOnlyCatalogueRequests() const;
 
-        void HandleBaseRequests(const json::Array&);
-        // Вспомогательные методы
-        void BusAddRequests(const std::deque<const json::Dict*>& requests);
-        void InsertDistances(const std::unordered_map<std::string_view, const json::Dict*>& requests);
+        // Загружает описания остановок, расстояний и автобусов в db одним пакетом
+        void HandleBaseRequests(TransportCatalogue& db);
 
-        void HandleStatRequests(const json::Array&, std::ostream&) const;
-        // Вспомогательные методы
-        json::Dict GetBusStat(std::string_view bus_name, int request_id) const;
-        json::Dict GetStopStat(std::string_view stop_name, int request_id) const;
-        json::Dict RenderMap(int request_id) const;
-        json::Dict BuildRoute(int request_id, std::string_view from, std::string_view to) const;
+        // Ответы выводятся в поток по мере обработки запросов, не накапливаясь в памяти
+        void HandleStatRequests(std::ostream&, const TransportCatalogue& db) const;
+        // Вспомогательные методы, каждый выводит в response один ответ
+        template <typename Catalogue>
+        void PrintBusStat(json::StreamBuilder& response, const Catalogue& db, std::string_view bus_name,
+                          int request_id) const;
+        template <typename Catalogue>
+        void PrintStopStat(json::StreamBuilder& response, const Catalogue& db, std::string_view stop_name,
+                           int request_id) const;
+        void PrintNearestStops(json::StreamBuilder& response, const TransportCatalogue& db,
+                               const StatRequest& request) const;
+        void PrintStopsInArea(json::StreamBuilder& response, const TransportCatalogue& db,
+                              const StatRequest& request) const;
+        // Если map_json не nullptr, карта экранируется в него при первом запросе, а дальше выводится оттуда
+        void PrintMap(json::StreamBuilder& response, int request_id, std::string* map_json) const;
+        void PrintRoute(json::StreamBuilder& response, int request_id, std::string_view from,
+                        std::string_view to) const;
+        static void PrintNotFound(json::StreamBuilder& response, int request_id);
 
     };
 
@@ -1,6 +1,6 @@
 #include "map_renderer.h"
 
-#include <set>
+#include <vector>
 
 using namespace std::literals;
 
@@ -17,15 +17,32 @@ namespace transport_catalogue::service {
                     (max_lat_ - coords.lat) * zoom_coeff_ + padding_};
         }
 
-        bool StopPtrComparator::operator()(const domain::Stop* lhs, const domain::Stop* rhs) const {
-            return rhs->name > lhs->name;
-        }
-
     } // namespace detail
 
-    MapRenderer::MapRenderer(const RenderSettings& settings) : settings_(settings) {}
+    bool operator==(const RenderSettings& lhs, const RenderSettings& rhs) {
+        return lhs.width == rhs.width
+               && lhs.height == rhs.height
+               && lhs.padding == rhs.padding
+               && lhs.line_width == rhs.line_width
+               && lhs.stop_radius == rhs.stop_radius
+               && lhs.bus_label_font_size == rhs.bus_label_font_size
+               && lhs.bus_label_offsets == rhs.bus_label_offsets
+               && lhs.stop_label_font_size == rhs.stop_label_font_size
+               && lhs.stop_label_offsets == rhs.stop_label_offsets
+               && lhs.underlayer_color == rhs.underlayer_color
+               && lhs.underlayer_width == rhs.underlayer_width
+               && lhs.color_palette == rhs.color_palette;
+    }
+
+    bool operator!=(const RenderSettings& lhs, const RenderSettings& rhs) {
+        return !(lhs == rhs);
+    }
+
+    MapRenderer::MapRenderer(const RenderSettings& settings)
+    : settings_(settings) {}
 
-    MapRenderer::MapRenderer(RenderSettings&& settings) : settings_(std::move(settings)) {}
+    MapRenderer::MapRenderer(RenderSettings&& settings)
+    : settings_(std::move(settings)) {}
 
     void MapRenderer::UpdateSettings(const RenderSettings& settings) {
         settings_ = settings;
@@ -35,37 +52,63 @@ namespace transport_catalogue::service {
         settings_ = std::move(settings);
     }
 
-    void MapRenderer::Render(const std::deque<domain::Bus>& buses, std::ostream& out) const {
-        //сначала сортируем автобусы и остановки, чтобы рендерить их в нужном порядке
-        std::set<const domain::Stop*, detail::StopPtrComparator> sorted_stops;
-        std::vector<const domain::Bus*> sorted_buses;
-        sorted_buses.reserve(buses.size());
+    void MapRenderer::SetRenderedMap(std::string svg) {
+        rendered_map_ = RenderedMap{settings_, std::move(svg)};
+    }
 
-        for (const domain::Bus& bus : buses) {
-            if (bus.route.empty()) {
+    const RenderSettings& MapRenderer::GetSettings() const {
+        return settings_;
+    }
+
+    void MapRenderer::Render(const TransportCatalogue& db, std::ostream& out) const {
+        if (rendered_map_ && rendered_map_->settings == settings_) {
+            out.write(rendered_map_->svg.data(), static_cast<std::streamsize>(rendered_map_->svg.size()));
+            return;
+        }
+
+        //сначала сортируем автобусы и остановки, чтобы рендерить их в нужном порядке
+        std::vector<bool> is_stop_used(db.GetStopCount(), false);
+        std::vector<StopId> sorted_stops;
+        std::vector<BusId> sorted_buses;
+        sorted_buses.reserve(db.GetBusCount());
+
+        for (BusId bus = 0; bus < db.GetBusCount(); ++bus) {
+            const RouteRange route = db.GetBusRoute(bus);
+            if (route.empty()) {
                 continue;
             }
-            sorted_buses.push_back(&bus);
-            for (const domain::Stop* stop_ptr : bus.route) {
-                sorted_stops.insert(stop_ptr);
+            sorted_buses.push_back(bus);
+            for (StopId stop : route) {
+                if (!is_stop_used[stop]) {
+                    is_stop_used[stop] = true;
+                    sorted_stops.push_back(stop);
+                }
             }
         }
 
-        std::sort(sorted_buses.begin(), sorted_buses.end(), [](const domain::Bus* lhs, const domain::Bus* rhs) {
-            return rhs->name > lhs->name;
+        std::sort(sorted_buses.begin(), sorted_buses.end(), [&db](BusId lhs, BusId rhs) {
+            return db.GetBusName(lhs) < db.GetBusName(rhs);
+        });
+        std::sort(sorted_stops.begin(), sorted_stops.end(), [&db](StopId lhs, StopId rhs) {
+            return db.GetStopName(lhs) < db.GetStopName(rhs);
         });
 
         //создаём проектор
-        detail::SphereProjector projector(sorted_stops.begin(), sorted_stops.end(),
+        std::vector<geo::Coordinates> stops_coords;
+        stops_coords.reserve(sorted_stops.size());
+        for (StopId stop : sorted_stops) {
+            stops_coords.push_back(db.GetStopCoords(stop));
+        }
+        detail::SphereProjector projector(stops_coords.begin(), stops_coords.end(),
                                           settings_.width, settings_.height, settings_.padding);
 
         //начинаем рендеринг
         svg::Document canvas;
 
-        InsertLines(canvas, projector, sorted_buses);
-        InsertRouteNames(canvas, projector, sorted_buses);
-        InsertStopSymbols(canvas, projector, sorted_stops);
-        InsertStopNames(canvas, projector, sorted_stops);
+        InsertLines(canvas, projector, db, sorted_buses);
+        InsertRouteNames(canvas, projector, db, sorted_buses);
+        InsertStopSymbols(canvas, projector, db, sorted_stops);
+        InsertStopNames(canvas, projector, db, sorted_stops);
 
         canvas.Render(out);
     }
@@ -75,10 +118,10 @@ namespace transport_catalogue::service {
      */
 
     void MapRenderer::InsertLines(svg::Document& canvas, const detail::SphereProjector& projector,
-                                  const std::vector<const domain::Bus*>& sorted_buses) const {
+                                  const TransportCatalogue& db, const std::vector<BusId>& sorted_buses) const {
         //отрисовка линий маршрутов
         int i = 0;
-        for (const domain::Bus* bus_ptr : sorted_buses) {
+        for (BusId bus : sorted_buses) {
             std::unique_ptr<svg::Polyline> route(std::make_unique<svg::Polyline>());
             if (!settings_.color_palette.empty()) {
                 route->SetStrokeColor(
@@ -89,13 +132,14 @@ namespace transport_catalogue::service {
                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                     .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-            for (const domain::Stop* stop_ptr : bus_ptr->route) {
-                route->AddPoint(projector(stop_ptr->coords));
+            const RouteRange stops = db.GetBusRoute(bus);
+            for (StopId stop : stops) {
+                route->AddPoint(projector(db.GetStopCoords(stop)));
             }
 
-            if (bus_ptr->type == domain::RouteType::ONE_WAY && bus_ptr->route.size() > 1) {
-                for (size_t k = bus_ptr->route.size() - 1; k >= 1; --k) {
-                    route->AddPoint(projector(bus_ptr->route.at(k - 1)->coords));
+            if (db.GetBusType(bus) == domain::RouteType::ONE_WAY && stops.size() > 1) {
+                for (size_t k = stops.size() - 1; k >= 1; --k) {
+                    route->AddPoint(projector(db.GetStopCoords(stops[k - 1])));
                 }
             }
             canvas.AddPtr(std::move(route));
@@ -103,17 +147,18 @@ namespace transport_catalogue::service {
     }
 
     void MapRenderer::InsertRouteNames(svg::Document& canvas, const detail::SphereProjector& projector,
-                                       const std::vector<const domain::Bus*>& sorted_buses) const {
+                                       const TransportCatalogue& db, const std::vector<BusId>& sorted_buses) const {
         //отрисовка названий маршрутов
         int i = 0;
-        for (const domain::Bus* bus_ptr : sorted_buses) {
+        for (BusId bus : sorted_buses) {
             svg::Text bus_title_background;
 
-            const domain::Stop* fist_stop_ptr = bus_ptr->route.at(0);
+            const RouteRange stops = db.GetBusRoute(bus);
+            StopId first_stop = stops[0];
             bus_title_background.SetOffset(settings_.bus_label_offsets)
                     .SetFontSize(settings_.bus_label_font_size)
-                    .SetFontFamily("Verdana"s).SetFontWeight("bold"s).SetData(bus_ptr->name)
-                    .SetPosition(projector(fist_stop_ptr->coords));
+                    .SetFontFamily("Verdana"s).SetFontWeight("bold"s).SetData(std::string(db.GetBusName(bus)))
+                    .SetPosition(projector(db.GetStopCoords(first_stop)));
 
             svg::Text bus_title(bus_title_background);
             if (!settings_.color_palette.empty()) {
@@ -130,10 +175,10 @@ namespace transport_catalogue::service {
             canvas.AddPtr(std::make_unique<svg::Text>(bus_title_background));
             canvas.AddPtr(std::make_unique<svg::Text>(bus_title));
 
-            const domain::Stop* last_stop_ptr = bus_ptr->route.at(bus_ptr->route.size() - 1);
-            if (fist_stop_ptr != last_stop_ptr && bus_ptr->type == domain::RouteType::ONE_WAY) {
-                bus_title_background.SetPosition(projector(last_stop_ptr->coords));
-                bus_title.SetPosition(projector(last_stop_ptr->coords));
+            StopId last_stop = stops[stops.size() - 1];
+            if (first_stop != last_stop && db.GetBusType(bus) == domain::RouteType::ONE_WAY) {
+                bus_title_background.SetPosition(projector(db.GetStopCoords(last_stop)));
+                bus_title.SetPosition(projector(db.GetStopCoords(last_stop)));
 
                 canvas.AddPtr(std::make_unique<svg::Text>(std::move(bus_title_background)));
                 canvas.AddPtr(std::make_unique<svg::Text>(std::move(bus_title)));
@@ -142,28 +187,26 @@ namespace transport_catalogue::service {
     }
 
     void MapRenderer::InsertStopSymbols(svg::Document& canvas, const detail::SphereProjector& projector,
-                                        const std::set<const domain::Stop*,
-                                        detail::StopPtrComparator>& sorted_stops) const {
+                                        const TransportCatalogue& db, const std::vector<StopId>& sorted_stops) const {
         //отрисовка символов остановок
-        for (const domain::Stop* stop_ptr : sorted_stops) {
+        for (StopId stop : sorted_stops) {
             std::unique_ptr<svg::Circle> circle(std::make_unique<svg::Circle>());
-            circle->SetCenter(projector(stop_ptr->coords))
+            circle->SetCenter(projector(db.GetStopCoords(stop)))
                     .SetRadius(settings_.stop_radius).SetFillColor("white"s);
             canvas.AddPtr(std::move(circle));
         }
     }
 
     void MapRenderer::InsertStopNames(svg::Document& canvas, const detail::SphereProjector& projector,
-                                      const std::set<const domain::Stop*,
-                                      detail::StopPtrComparator>& sorted_stops) const {
+                                      const TransportCatalogue& db, const std::vector<StopId>& sorted_stops) const {
         //отрисовка названий остановок
-        for (const domain::Stop* stop_ptr : sorted_stops) {
+        for (StopId stop : sorted_stops) {
             std::unique_ptr<svg::Text> stop_title_background(std::make_unique<svg::Text>());
 
             stop_title_background->SetOffset(settings_.stop_label_offsets)
                     .SetFontSize(settings_.stop_label_font_size)
-                    .SetFontFamily("Verdana"s).SetData(stop_ptr->name)
-                    .SetPosition(projector(stop_ptr->coords));
+                    .SetFontFamily("Verdana"s).SetData(std::string(db.GetStopName(stop)))
+                    .SetPosition(projector(db.GetStopCoords(stop)));
 
             std::unique_ptr<svg::Text> stop_title(std::make_unique<svg::Text>(*stop_title_background));
             stop_title->SetFillColor("black"s);
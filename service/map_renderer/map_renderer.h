@@ -1,10 +1,12 @@
 #pragma once
 
 #include <algorithm>
-#include <set>
+#include <optional>
+#include <vector>
+#include <string>
 
 #include "svg/svg.h"
-#include "transport_catalogue/domain.h"
+#include "transport_catalogue/transport_catalogue.h"
 #include "geo/geo.h"
 
 namespace transport_catalogue::service {
@@ -16,27 +18,27 @@ namespace transport_catalogue::service {
 
         class SphereProjector {
         public:
-            template <typename StopInputIt>
-            SphereProjector(StopInputIt stops_begin, StopInputIt stops_end, double max_width,
+            template <typename CoordsInputIt>
+            SphereProjector(CoordsInputIt coords_begin, CoordsInputIt coords_end, double max_width,
                             double max_height, double padding)
                     : padding_(padding) {
-                if (stops_begin == stops_end) {
+                if (coords_begin == coords_end) {
                     return;
                 }
 
                 const auto [left_it, right_it]
-                = std::minmax_element(stops_begin, stops_end, [](const auto lhs, const auto rhs) {
-                    return lhs->coords.lng < rhs->coords.lng;
+                = std::minmax_element(coords_begin, coords_end, [](const auto& lhs, const auto& rhs) {
+                    return lhs.lng < rhs.lng;
                 });
-                min_lon_ = (*left_it)->coords.lng;
-                const double max_lon = (*right_it)->coords.lng;
+                min_lon_ = left_it->lng;
+                const double max_lon = right_it->lng;
 
                 const auto [bottom_it, top_it]
-                = std::minmax_element(stops_begin, stops_end, [](const auto lhs, const auto rhs) {
-                    return lhs->coords.lat < rhs->coords.lat;
+                = std::minmax_element(coords_begin, coords_end, [](const auto& lhs, const auto& rhs) {
+                    return lhs.lat < rhs.lat;
                 });
-                const double min_lat = (*bottom_it)->coords.lat;
-                max_lat_ = (*top_it)->coords.lat;
+                const double min_lat = bottom_it->lat;
+                max_lat_ = top_it->lat;
 
                 std::optional<double> width_zoom;
                 if (!IsZero(max_lon - min_lon_)) {
@@ -66,10 +68,6 @@ namespace transport_catalogue::service {
             double zoom_coeff_ = 0;
         };
 
-        struct StopPtrComparator {
-            bool operator()(const domain::Stop* lhs, const domain::Stop* rhs) const;
-        };
-
     } // namespace detail
 
     struct RenderSettings {
@@ -93,32 +91,47 @@ namespace transport_catalogue::service {
         std::vector<svg::Color> color_palette;
     };
 
+    // Настройки сравниваются поле за полем, так проверяется, подходит ли заранее отрисованная карта
+    bool operator==(const RenderSettings& lhs, const RenderSettings& rhs);
+    bool operator!=(const RenderSettings& lhs, const RenderSettings& rhs);
+
     class MapRenderer {
     public:
         MapRenderer() = default;
         MapRenderer(const RenderSettings& settings);
         MapRenderer(RenderSettings&& settings);
 
-        void Render(const std::deque<domain::Bus>& buses, std::ostream& out) const;
+        // Если есть заранее отрисованная карта для текущих настроек, выводит её, не глядя на каталог
+        void Render(const TransportCatalogue& db, std::ostream& out) const;
 
         void UpdateSettings(const RenderSettings& settings);
         void UpdateSettings(RenderSettings&& settings);
+        const RenderSettings& GetSettings() const;
+
+        // Запоминает готовую карту, отрисованную с текущими настройками
+        void SetRenderedMap(std::string svg);
 
     private:
         RenderSettings settings_;
 
+        struct RenderedMap {
+            RenderSettings settings;
+            std::string svg;
+        };
+        std::optional<RenderedMap> rendered_map_;
+
         //дальше создание слоёв карты
         void InsertLines(svg::Document& canvas, const detail::SphereProjector& projector,
-                         const std::vector<const domain::Bus*>& sorted_buses) const;
+                         const TransportCatalogue& db, const std::vector<BusId>& sorted_buses) const;
 
         void InsertRouteNames(svg::Document& canvas, const detail::SphereProjector& projector,
-                              const std::vector<const domain::Bus*>& sorted_buses) const;
+                              const TransportCatalogue& db, const std::vector<BusId>& sorted_buses) const;
 
         void InsertStopSymbols(svg::Document& canvas, const detail::SphereProjector& projector,
-                               const std::set<const domain::Stop*, detail::StopPtrComparator>& sorted_stops) const;
+                               const TransportCatalogue& db, const std::vector<StopId>& sorted_stops) const;
 
         void InsertStopNames(svg::Document& canvas, const detail::SphereProjector& projector,
-                               const std::set<const domain::Stop*, detail::StopPtrComparator>& sorted_stops) const;
+                             const TransportCatalogue& db, const std::vector<StopId>& sorted_stops) const;
     };
 
 } // namespace transport_catalogue::service
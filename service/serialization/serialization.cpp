@@ -0,0 +1,820 @@
+#include "serialization.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <optional>
+#include <sstream>
+
+#include <transport_catalogue.pb.h>
+
+namespace transport_catalogue::service {
+
+    namespace proto = transport_catalogue_serialize;
+
+    namespace {
+
+        proto::Point SavePoint(svg::Point point) {
+            proto::Point result;
+            result.set_x(point.x);
+            result.set_y(point.y);
+            return result;
+        }
+
+        svg::Point LoadPoint(const proto::Point& point) {
+            return {point.x(), point.y()};
+        }
+
+        struct ColorSaver {
+            proto::Color& result;
+
+            void operator()(std::monostate) const {}
+
+            void operator()(const std::string& name) const {
+                result.set_name(name);
+            }
+
+            void operator()(svg::Rgb color) const {
+                proto::Rgb& rgb = *result.mutable_rgb();
+                rgb.set_red(color.red);
+                rgb.set_green(color.green);
+                rgb.set_blue(color.blue);
+            }
+
+            void operator()(svg::Rgba color) const {
+                proto::Rgba& rgba = *result.mutable_rgba();
+                rgba.set_red(color.red);
+                rgba.set_green(color.green);
+                rgba.set_blue(color.blue);
+                rgba.set_opacity(color.opacity);
+            }
+        };
+
+        proto::Color SaveColor(const svg::Color& color) {
+            proto::Color result;
+            std::visit(ColorSaver{result}, color);
+            return result;
+        }
+
+        svg::Color LoadColor(const proto::Color& color) {
+            switch (color.color_case()) {
+                case proto::Color::kName:
+                    return color.name();
+                case proto::Color::kRgb:
+                    return svg::Rgb {
+                            static_cast<uint8_t>(color.rgb().red()),
+                            static_cast<uint8_t>(color.rgb().green()),
+                            static_cast<uint8_t>(color.rgb().blue()),
+                    };
+                case proto::Color::kRgba:
+                    return svg::Rgba {
+                            static_cast<uint8_t>(color.rgba().red()),
+                            static_cast<uint8_t>(color.rgba().green()),
+                            static_cast<uint8_t>(color.rgba().blue()),
+                            color.rgba().opacity(),
+                    };
+                default:
+                    return {};
+            }
+        }
+
+        //Остановки и автобусы в базе ссылаются друг на друга по номерам в каталоге
+        proto::TransportCatalogue SaveCatalogue(const TransportCatalogue& db) {
+            proto::TransportCatalogue result;
+
+            for (StopId stop = 0; stop < db.GetStopCount(); ++stop) {
+                const geo::Coordinates coords = db.GetStopCoords(stop);
+                proto::Stop& saved_stop = *result.add_stops();
+                saved_stop.set_name(std::string(db.GetStopName(stop)));
+                saved_stop.mutable_coords()->set_lat(coords.lat);
+                saved_stop.mutable_coords()->set_lng(coords.lng);
+            }
+
+            for (const auto& [stops, length] : db.GetDistances()) {
+                proto::Distance& distance = *result.add_distances();
+                distance.set_from(stops.first);
+                distance.set_to(stops.second);
+                distance.set_length(length);
+            }
+
+            for (BusId bus = 0; bus < db.GetBusCount(); ++bus) {
+                proto::Bus& saved_bus = *result.add_buses();
+                saved_bus.set_name(std::string(db.GetBusName(bus)));
+                saved_bus.set_is_roundtrip(db.GetBusType(bus) == RouteType::ROUND_TRIP);
+                for (StopId stop : db.GetBusRoute(bus)) {
+                    saved_bus.add_route(stop);
+                }
+            }
+
+            return result;
+        }
+
+        //Номера из базы проверяются до обращения по ним: повреждённая база даёт false, а не мусор в памяти
+        bool IsValidStop(const proto::TransportCatalogue& catalogue, uint32_t stop_id) {
+            return stop_id < static_cast<uint32_t>(catalogue.stops_size());
+        }
+
+        bool LoadCatalogue(const proto::TransportCatalogue& catalogue, TransportCatalogue& db) {
+            std::vector<StopDescription> stops;
+            stops.reserve(catalogue.stops_size());
+            for (const proto::Stop& stop : catalogue.stops()) {
+                stops.push_back({stop.name(), {stop.coords().lat(), stop.coords().lng()}});
+            }
+
+            //В базе лежит уже полная таблица расстояний в обе стороны, поэтому порядок вставки неважен:
+            //явное значение всегда перезапишет обратное, добавленное по умолчанию
+            std::vector<DistanceDescription> distances;
+            distances.reserve(catalogue.distances_size());
+            for (const proto::Distance& distance : catalogue.distances()) {
+                if (!IsValidStop(catalogue, distance.from()) || !IsValidStop(catalogue, distance.to())) {
+                    return false;
+                }
+                distances.push_back({catalogue.stops(distance.from()).name(),
+                                     catalogue.stops(distance.to()).name(), distance.length()});
+            }
+
+            std::vector<BusDescription> buses;
+            buses.reserve(catalogue.buses_size());
+            for (const proto::Bus& bus : catalogue.buses()) {
+                BusDescription& description = buses.emplace_back();
+                description.name = bus.name();
+                description.stops.reserve(bus.route_size());
+                for (uint32_t stop_id : bus.route()) {
+                    if (!IsValidStop(catalogue, stop_id)) {
+                        return false;
+                    }
+                    description.stops.emplace_back(catalogue.stops(stop_id).name());
+                }
+                description.type = bus.is_roundtrip() ? RouteType::ROUND_TRIP : RouteType::ONE_WAY;
+            }
+
+            db.AddBulk(stops, distances, buses);
+            db.Finalize();
+            return true;
+        }
+
+        proto::RenderSettings SaveRenderSettings(const RenderSettings& settings) {
+            proto::RenderSettings result;
+
+            result.set_width(settings.width);
+            result.set_height(settings.height);
+            result.set_padding(settings.padding);
+            result.set_line_width(settings.line_width);
+            result.set_stop_radius(settings.stop_radius);
+
+            result.set_bus_label_font_size(settings.bus_label_font_size);
+            *result.mutable_bus_label_offsets() = SavePoint(settings.bus_label_offsets);
+
+            result.set_stop_label_font_size(settings.stop_label_font_size);
+            *result.mutable_stop_label_offsets() = SavePoint(settings.stop_label_offsets);
+
+            *result.mutable_underlayer_color() = SaveColor(settings.underlayer_color);
+            result.set_underlayer_width(settings.underlayer_width);
+
+            for (const svg::Color& color : settings.color_palette) {
+                *result.add_color_palette() = SaveColor(color);
+            }
+
+            return result;
+        }
+
+        RenderSettings LoadRenderSettings(const proto::RenderSettings& settings) {
+            RenderSettings result {
+                    settings.width(),
+                    settings.height(),
+
+                    settings.padding(),
+
+                    settings.line_width(),
+                    settings.stop_radius(),
+
+                    settings.bus_label_font_size(),
+                    LoadPoint(settings.bus_label_offsets()),
+
+                    settings.stop_label_font_size(),
+                    LoadPoint(settings.stop_label_offsets()),
+
+                    LoadColor(settings.underlayer_color()),
+                    settings.underlayer_width(),
+
+                    {}
+            };
+
+            result.color_palette.reserve(settings.color_palette_size());
+            for (const proto::Color& color : settings.color_palette()) {
+                result.color_palette.push_back(LoadColor(color));
+            }
+
+            return result;
+        }
+
+        proto::TransportRouter SaveRouter(const TransportRouter& transport_router) {
+            proto::TransportRouter result;
+
+            const RouterSettings& settings = transport_router.GetSettings();
+            result.mutable_settings()->set_bus_wait_time(settings.bus_wait_time);
+            result.mutable_settings()->set_bus_velocity(settings.bus_velocity);
+
+            const graph::DirectedWeightedGraph<double>& graph = transport_router.GetGraph();
+            const std::vector<EdgeInfo>& edges_info = transport_router.GetEdgesInfo();
+            const size_t vertex_count = graph.GetVertexCount();
+            result.set_vertex_count(static_cast<uint32_t>(vertex_count));
+
+            for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+                const graph::Edge<double>& edge = graph.GetEdge(edge_id);
+                proto::Edge& saved_edge = *result.add_edges();
+                saved_edge.set_from(static_cast<uint32_t>(edge.from));
+                saved_edge.set_to(static_cast<uint32_t>(edge.to));
+                saved_edge.set_weight(edge.weight);
+
+                const EdgeInfo& info = edges_info[edge_id];
+                proto::EdgeInfo& saved_info = *result.add_edges_info();
+                saved_info.set_is_waiting_edge(info.is_waiting_edge);
+                saved_info.set_duration(info.duration);
+                saved_info.set_span_count(static_cast<uint32_t>(info.span_count));
+                saved_info.set_bus(info.bus);
+                saved_info.set_stop(info.stop);
+            }
+
+            const std::vector<std::optional<graph::EdgeId>>& stop_hubs = transport_router.GetStopHubs();
+            for (StopId stop = 0; stop < stop_hubs.size(); ++stop) {
+                if (!stop_hubs[stop]) {
+                    continue;
+                }
+                proto::StopHub& hub = *result.add_stop_hubs();
+                hub.set_stop(stop);
+                hub.set_edge(static_cast<uint32_t>(*stop_hubs[stop]));
+            }
+
+            proto::RoutesInternalData& routes = *result.mutable_routes_internal_data();
+            routes.mutable_prev_edges()->Reserve(static_cast<int>(vertex_count * vertex_count));
+            for (const auto& row : transport_router.GetRouter().GetRoutesInternalData()) {
+                for (const auto& route : row) {
+                    if (!route) {
+                        routes.add_prev_edges(0);
+                        continue;
+                    }
+                    routes.add_prev_edges(route->prev_edge ? static_cast<uint32_t>(*route->prev_edge) + 2 : 1);
+                    routes.add_weights(route->weight);
+                }
+            }
+
+            return result;
+        }
+
+        //Цепочка предыдущих рёбер каждого найденного маршрута должна дойти до его начала, не зацикливаясь,
+        //иначе Router::BuildRoute по ней не пройдёт
+        bool IsValidRoutesTable(const graph::DirectedWeightedGraph<double>& graph,
+                                const graph::Router<double>::RoutesInternalData& routes_internal_data) {
+            enum class State : uint8_t {UNKNOWN, ON_PATH, VALID};
+            const size_t vertex_count = graph.GetVertexCount();
+            std::vector<State> states;
+            std::vector<graph::VertexId> path;
+            for (const auto& row : routes_internal_data) {
+                states.assign(vertex_count, State::UNKNOWN);
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    if (!row[to]) {
+                        continue;
+                    }
+                    path.clear();
+                    graph::VertexId vertex = to;
+                    while (states[vertex] == State::UNKNOWN) {
+                        const auto& route = row[vertex];
+                        if (!route) {
+                            return false;
+                        }
+                        states[vertex] = State::ON_PATH;
+                        path.push_back(vertex);
+                        if (!route->prev_edge) {
+                            states[vertex] = State::VALID;
+                            break;
+                        }
+                        const graph::Edge<double>& edge = graph.GetEdge(*route->prev_edge);
+                        if (edge.to != vertex) {
+                            return false;
+                        }
+                        vertex = edge.from;
+                    }
+                    if (states[vertex] == State::ON_PATH) {
+                        return false;
+                    }
+                    for (graph::VertexId on_path : path) {
+                        states[on_path] = State::VALID;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool LoadRouter(const proto::TransportRouter& router, const TransportCatalogue& db,
+                        TransportRouter& transport_router) {
+            //Таблица маршрутов хранится построчно, V x V ячеек, и на каждую найденную ячейку есть вес
+            const size_t vertex_count = router.vertex_count();
+            const proto::RoutesInternalData& routes = router.routes_internal_data();
+            if (static_cast<size_t>(routes.prev_edges_size()) != vertex_count * vertex_count
+                || router.edges_info_size() != router.edges_size()) {
+                return false;
+            }
+            const size_t edge_count = router.edges_size();
+            const size_t found_count = std::count_if(routes.prev_edges().begin(), routes.prev_edges().end(),
+                                                     [](uint32_t prev_edge) { return prev_edge != 0; });
+            if (static_cast<size_t>(routes.weights_size()) != found_count
+                || std::any_of(routes.prev_edges().begin(), routes.prev_edges().end(), [edge_count](uint32_t prev_edge) {
+                    return prev_edge >= 2 && prev_edge - 2 >= edge_count;
+                })) {
+                return false;
+            }
+
+            transport_router.UpdateSettings({
+                    router.settings().bus_wait_time(),
+                    router.settings().bus_velocity()
+            });
+
+            graph::DirectedWeightedGraph<double> graph(vertex_count);
+            std::vector<EdgeInfo> edge_to_info;
+            edge_to_info.reserve(router.edges_size());
+
+            for (int i = 0; i < router.edges_size(); ++i) {
+                const proto::Edge& edge = router.edges(i);
+                const proto::EdgeInfo& info = router.edges_info(i);
+                if (edge.from() >= vertex_count || edge.to() >= vertex_count
+                    || info.stop() >= db.GetStopCount() || (!info.is_waiting_edge() && info.bus() >= db.GetBusCount())) {
+                    return false;
+                }
+                graph.AddEdge({edge.from(), edge.to(), edge.weight()});
+
+                edge_to_info.push_back({
+                        info.is_waiting_edge(),
+                        info.duration(),
+                        info.span_count(),
+                        info.bus(),
+                        info.stop()
+                });
+            }
+
+            std::vector<std::optional<graph::EdgeId>> stop_to_hub(db.GetStopCount());
+            for (const proto::StopHub& hub : router.stop_hubs()) {
+                if (hub.stop() >= stop_to_hub.size() || hub.edge() >= edge_count) {
+                    return false;
+                }
+                stop_to_hub[hub.stop()] = hub.edge();
+            }
+
+            graph::Router<double>::RoutesInternalData routes_internal_data(
+                    vertex_count, std::vector<std::optional<graph::Router<double>::RouteInternalData>>(vertex_count));
+            int route_index = 0;
+            int weight_index = 0;
+            for (auto& row : routes_internal_data) {
+                for (auto& route : row) {
+                    uint32_t prev_edge = routes.prev_edges(route_index++);
+                    if (prev_edge == 0) {
+                        continue;
+                    }
+                    route = graph::Router<double>::RouteInternalData{
+                            routes.weights(weight_index++),
+                            prev_edge == 1 ? std::nullopt : std::optional<graph::EdgeId>(prev_edge - 2)
+                    };
+                }
+            }
+
+            if (!IsValidRoutesTable(graph, routes_internal_data)) {
+                return false;
+            }
+            transport_router.RestoreGraph(std::move(graph), std::move(stop_to_hub),
+                                          std::move(edge_to_info), std::move(routes_internal_data));
+            return true;
+        }
+
+        //Хэш FNV-1a содержимого каталога. Не зависит от адресов в памяти и порядка обхода хэш-таблиц
+        class VersionHasher {
+        public:
+            void Add(const void* data, size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    hash_ ^= bytes[i];
+                    hash_ *= 1099511628211ull;
+                }
+            }
+
+            template <typename Value>
+            void Add(Value value) {
+                Add(&value, sizeof(value));
+            }
+
+            void Add(std::string_view value) {
+                Add(value.size());
+                Add(value.data(), value.size());
+            }
+
+            uint64_t Get() const {
+                return hash_;
+            }
+
+        private:
+            uint64_t hash_ = 14695981039346656037ull;
+        };
+
+        using NamedDistances = std::map<std::pair<std::string_view, std::string_view>, int>;
+
+        NamedDistances GetNamedDistances(const TransportCatalogue& db) {
+            NamedDistances result;
+            for (const auto& [stops, length] : db.GetDistances()) {
+                result[{db.GetStopName(stops.first), db.GetStopName(stops.second)}] = length;
+            }
+            return result;
+        }
+
+        bool IsSameRoute(const TransportCatalogue& lhs_db, BusId lhs, const TransportCatalogue& rhs_db, BusId rhs) {
+            const RouteRange lhs_route = lhs_db.GetBusRoute(lhs);
+            const RouteRange rhs_route = rhs_db.GetBusRoute(rhs);
+            if (lhs_db.GetBusType(lhs) != rhs_db.GetBusType(rhs) || lhs_route.size() != rhs_route.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < lhs_route.size(); ++i) {
+                if (lhs_db.GetStopName(lhs_route[i]) != rhs_db.GetStopName(rhs_route[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void SetNamedDistance(proto::NamedDistance& distance, std::string_view from, std::string_view to, int length) {
+            distance.set_from(std::string(from));
+            distance.set_to(std::string(to));
+            distance.set_length(length);
+        }
+
+        //Обновление можно применить на месте, если оно только добавляет новые объекты
+        //и не трогает расстояния между старыми остановками: тогда номера в каталоге и графе сохраняются
+        bool IsAdditiveDelta(const proto::TransportCatalogue& catalogue, const proto::BaseDelta& delta) {
+            if (delta.removed_stops_size() > 0 || delta.removed_buses_size() > 0 || delta.removed_distances_size() > 0) {
+                return false;
+            }
+
+            std::unordered_set<std::string_view> old_stops;
+            old_stops.reserve(catalogue.stops_size());
+            for (const proto::Stop& stop : catalogue.stops()) {
+                old_stops.insert(stop.name());
+            }
+            for (const proto::Stop& stop : delta.stops()) {
+                if (old_stops.count(stop.name()) > 0) {
+                    return false;
+                }
+            }
+            for (const proto::NamedDistance& distance : delta.distances()) {
+                if (old_stops.count(distance.from()) > 0 && old_stops.count(distance.to()) > 0) {
+                    return false;
+                }
+            }
+
+            std::unordered_set<std::string_view> old_buses;
+            old_buses.reserve(catalogue.buses_size());
+            for (const proto::Bus& bus : catalogue.buses()) {
+                old_buses.insert(bus.name());
+            }
+            for (const proto::NamedBus& bus : delta.buses()) {
+                if (old_buses.count(bus.name()) > 0) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        //Добавляет объекты обновления в уже загруженный каталог и достраивает граф
+        bool ApplyAdditiveDelta(const proto::BaseDelta& delta, TransportCatalogue& db,
+                                TransportRouter& transport_router) {
+            const size_t first_new_bus = db.GetBusCount();
+
+            for (const proto::Stop& stop : delta.stops()) {
+                db.AddStop(stop.name(), stop.coords().lat(), stop.coords().lng());
+            }
+            for (const proto::NamedDistance& distance : delta.distances()) {
+                if (!db.IsStopExists(distance.from()) || !db.IsStopExists(distance.to())) {
+                    return false;
+                }
+                db.AddDistance(distance.from(), distance.to(), distance.length());
+            }
+
+            std::vector<std::string_view> route;
+            for (const proto::NamedBus& bus : delta.buses()) {
+                route.assign(bus.stops().begin(), bus.stops().end());
+                for (std::string_view stop : route) {
+                    if (!db.IsStopExists(stop)) {
+                        return false;
+                    }
+                }
+                db.AddBus(bus.name(), route, bus.is_roundtrip() ? RouteType::ROUND_TRIP : RouteType::ONE_WAY);
+            }
+            db.Finalize();
+
+            if (transport_router.IsGraphBuilt()) {
+                transport_router.AddBuses(first_new_bus);
+            }
+            return true;
+        }
+
+        //Собирает новый каталог из сохранённого и обновления. Возвращает nullopt, если обновление не сходится с базой
+        std::optional<proto::TransportCatalogue> MergeDelta(const proto::TransportCatalogue& catalogue,
+                                                            const proto::BaseDelta& delta) {
+            proto::TransportCatalogue result;
+
+            //Остановки: старые по порядку без удалённых и с новыми координатами, затем новые
+            const std::unordered_set<std::string_view> removed_stops(delta.removed_stops().begin(),
+                                                                     delta.removed_stops().end());
+            std::unordered_map<std::string_view, const proto::Stop*> updated_stops;
+            for (const proto::Stop& stop : delta.stops()) {
+                updated_stops[stop.name()] = &stop;
+            }
+
+            std::unordered_map<std::string_view, uint32_t> stop_ids;
+            std::vector<std::optional<uint32_t>> old_to_new(catalogue.stops_size());
+            auto add_stop = [&result, &stop_ids](const proto::Stop& stop) {
+                uint32_t id = static_cast<uint32_t>(result.stops_size());
+                *result.add_stops() = stop;
+                stop_ids[stop.name()] = id;
+                return id;
+            };
+
+            for (int i = 0; i < catalogue.stops_size(); ++i) {
+                const proto::Stop& stop = catalogue.stops(i);
+                if (removed_stops.count(stop.name()) > 0) {
+                    continue;
+                }
+                auto updated = updated_stops.find(stop.name());
+                if (updated != updated_stops.end()) {
+                    old_to_new[i] = add_stop(*updated->second);
+                    updated_stops.erase(updated);
+                } else {
+                    old_to_new[i] = add_stop(stop);
+                }
+            }
+            for (const proto::Stop& stop : delta.stops()) {
+                if (updated_stops.count(stop.name()) > 0) {
+                    add_stop(stop);
+                }
+            }
+
+            //Расстояния: старые без удалённых, поверх них новые
+            std::map<std::pair<uint32_t, uint32_t>, int> distances;
+            for (const proto::Distance& distance : catalogue.distances()) {
+                if (!IsValidStop(catalogue, distance.from()) || !IsValidStop(catalogue, distance.to())) {
+                    return std::nullopt;
+                }
+                if (old_to_new[distance.from()] && old_to_new[distance.to()]) {
+                    distances[{*old_to_new[distance.from()], *old_to_new[distance.to()]}] = distance.length();
+                }
+            }
+            for (const proto::NamedDistance& distance : delta.removed_distances()) {
+                if (stop_ids.count(distance.from()) > 0 && stop_ids.count(distance.to()) > 0) {
+                    distances.erase({stop_ids.at(distance.from()), stop_ids.at(distance.to())});
+                }
+            }
+            for (const proto::NamedDistance& distance : delta.distances()) {
+                if (stop_ids.count(distance.from()) == 0 || stop_ids.count(distance.to()) == 0) {
+                    return std::nullopt;
+                }
+                distances[{stop_ids.at(distance.from()), stop_ids.at(distance.to())}] = distance.length();
+            }
+            for (const auto& [stops, length] : distances) {
+                proto::Distance& distance = *result.add_distances();
+                distance.set_from(stops.first);
+                distance.set_to(stops.second);
+                distance.set_length(length);
+            }
+
+            //Автобусы: старые без удалённых, изменённые на своих местах, затем новые
+            const std::unordered_set<std::string_view> removed_buses(delta.removed_buses().begin(),
+                                                                     delta.removed_buses().end());
+            std::unordered_map<std::string_view, const proto::NamedBus*> updated_buses;
+            for (const proto::NamedBus& bus : delta.buses()) {
+                updated_buses[bus.name()] = &bus;
+            }
+
+            auto add_named_bus = [&result, &stop_ids](const proto::NamedBus& bus) {
+                proto::Bus& new_bus = *result.add_buses();
+                new_bus.set_name(bus.name());
+                new_bus.set_is_roundtrip(bus.is_roundtrip());
+                for (const std::string& stop : bus.stops()) {
+                    if (stop_ids.count(stop) == 0) {
+                        return false;
+                    }
+                    new_bus.add_route(stop_ids.at(stop));
+                }
+                return true;
+            };
+
+            for (const proto::Bus& bus : catalogue.buses()) {
+                if (removed_buses.count(bus.name()) > 0) {
+                    continue;
+                }
+                auto updated = updated_buses.find(bus.name());
+                if (updated != updated_buses.end()) {
+                    if (!add_named_bus(*updated->second)) {
+                        return std::nullopt;
+                    }
+                    updated_buses.erase(updated);
+                    continue;
+                }
+                proto::Bus& new_bus = *result.add_buses();
+                new_bus.set_name(bus.name());
+                new_bus.set_is_roundtrip(bus.is_roundtrip());
+                for (uint32_t stop_id : bus.route()) {
+                    if (!IsValidStop(catalogue, stop_id) || !old_to_new[stop_id]) {
+                        return std::nullopt;
+                    }
+                    new_bus.add_route(*old_to_new[stop_id]);
+                }
+            }
+            for (const proto::NamedBus& bus : delta.buses()) {
+                if (updated_buses.count(bus.name()) > 0 && !add_named_bus(bus)) {
+                    return std::nullopt;
+                }
+            }
+
+            return result;
+        }
+
+    } // namespace
+
+    uint64_t ComputeBaseVersion(const TransportCatalogue& db) {
+        VersionHasher hasher;
+
+        hasher.Add(db.GetStopCount());
+        for (StopId stop = 0; stop < db.GetStopCount(); ++stop) {
+            const geo::Coordinates coords = db.GetStopCoords(stop);
+            hasher.Add(db.GetStopName(stop));
+            hasher.Add(coords.lat);
+            hasher.Add(coords.lng);
+        }
+
+        hasher.Add(db.GetBusCount());
+        for (BusId bus = 0; bus < db.GetBusCount(); ++bus) {
+            const RouteRange route = db.GetBusRoute(bus);
+            hasher.Add(db.GetBusName(bus));
+            hasher.Add(static_cast<uint32_t>(db.GetBusType(bus)));
+            hasher.Add(route.size());
+            for (StopId stop : route) {
+                hasher.Add(stop);
+            }
+        }
+
+        std::vector<std::tuple<uint32_t, uint32_t, int>> distances;
+        distances.reserve(db.GetDistances().size());
+        for (const auto& [stops, length] : db.GetDistances()) {
+            distances.emplace_back(stops.first, stops.second, length);
+        }
+        std::sort(distances.begin(), distances.end());
+        hasher.Add(distances.size());
+        for (const auto& [from, to, length] : distances) {
+            hasher.Add(from);
+            hasher.Add(to);
+            hasher.Add(length);
+        }
+
+        return hasher.Get();
+    }
+
+    void SerializeBase(const TransportCatalogue& db, const MapRenderer& map_renderer,
+                       const TransportRouter& transport_router, std::ostream& out) {
+        proto::TransportBase base;
+
+        *base.mutable_catalogue() = SaveCatalogue(db);
+        *base.mutable_render_settings() = SaveRenderSettings(map_renderer.GetSettings());
+
+        //Маршрутизатор сохраняем целиком, только если граф был построен
+        if (transport_router.IsGraphBuilt()) {
+            *base.mutable_router() = SaveRouter(transport_router);
+        }
+
+        base.set_version(ComputeBaseVersion(db));
+
+        //Карту рисуем один раз здесь, чтобы запросы Map отдавали готовые байты
+        std::ostringstream svg;
+        map_renderer.Render(db, svg);
+        base.mutable_map()->set_svg(svg.str());
+
+        base.SerializeToOstream(&out);
+    }
+
+    bool DeserializeBase(std::istream& in, TransportCatalogue& db, MapRenderer& map_renderer,
+                         TransportRouter& transport_router) {
+        proto::TransportBase base;
+        if (!base.ParseFromIstream(&in)) {
+            return false;
+        }
+
+        if (!LoadCatalogue(base.catalogue(), db)) {
+            return false;
+        }
+        //Карта отрисована с сохранёнными настройками, с ними её и запоминаем
+        map_renderer.UpdateSettings(LoadRenderSettings(base.render_settings()));
+        if (base.has_map()) {
+            map_renderer.SetRenderedMap(std::move(*base.mutable_map()->mutable_svg()));
+        }
+
+        return !base.has_router() || LoadRouter(base.router(), db, transport_router);
+    }
+
+    void SerializeDelta(const TransportCatalogue& old_db, const TransportCatalogue& new_db, std::ostream& out) {
+        proto::BaseDelta delta;
+        delta.set_base_version(ComputeBaseVersion(old_db));
+
+        for (StopId stop = 0; stop < new_db.GetStopCount(); ++stop) {
+            const std::string_view name = new_db.GetStopName(stop);
+            const geo::Coordinates coords = new_db.GetStopCoords(stop);
+            std::optional<StopId> old_stop = old_db.FindStop(name);
+            if (!old_stop || old_db.GetStopCoords(*old_stop).lat != coords.lat
+                || old_db.GetStopCoords(*old_stop).lng != coords.lng) {
+                proto::Stop& saved_stop = *delta.add_stops();
+                saved_stop.set_name(std::string(name));
+                saved_stop.mutable_coords()->set_lat(coords.lat);
+                saved_stop.mutable_coords()->set_lng(coords.lng);
+            }
+        }
+        for (StopId stop = 0; stop < old_db.GetStopCount(); ++stop) {
+            if (!new_db.IsStopExists(old_db.GetStopName(stop))) {
+                delta.add_removed_stops(std::string(old_db.GetStopName(stop)));
+            }
+        }
+
+        const NamedDistances old_distances = GetNamedDistances(old_db);
+        const NamedDistances new_distances = GetNamedDistances(new_db);
+        for (const auto& [stops, length] : new_distances) {
+            auto old_distance = old_distances.find(stops);
+            if (old_distance == old_distances.end() || old_distance->second != length) {
+                SetNamedDistance(*delta.add_distances(), stops.first, stops.second, length);
+            }
+        }
+        for (const auto& [stops, length] : old_distances) {
+            if (new_distances.count(stops) == 0) {
+                SetNamedDistance(*delta.add_removed_distances(), stops.first, stops.second, length);
+            }
+        }
+
+        for (BusId bus = 0; bus < new_db.GetBusCount(); ++bus) {
+            const std::string_view name = new_db.GetBusName(bus);
+            std::optional<BusId> old_bus = old_db.FindBus(name);
+            if (old_bus && IsSameRoute(old_db, *old_bus, new_db, bus)) {
+                continue;
+            }
+            proto::NamedBus& saved_bus = *delta.add_buses();
+            saved_bus.set_name(std::string(name));
+            saved_bus.set_is_roundtrip(new_db.GetBusType(bus) == RouteType::ROUND_TRIP);
+            for (StopId stop : new_db.GetBusRoute(bus)) {
+                saved_bus.add_stops(std::string(new_db.GetStopName(stop)));
+            }
+        }
+        for (BusId bus = 0; bus < old_db.GetBusCount(); ++bus) {
+            if (!new_db.IsBusExists(old_db.GetBusName(bus))) {
+                delta.add_removed_buses(std::string(old_db.GetBusName(bus)));
+            }
+        }
+
+        delta.SerializeToOstream(&out);
+    }
+
+    bool DeserializeBase(std::istream& in, std::istream& delta_in, TransportCatalogue& db,
+                         MapRenderer& map_renderer, TransportRouter& transport_router) {
+        proto::TransportBase base;
+        proto::BaseDelta delta;
+        if (!base.ParseFromIstream(&in) || !delta.ParseFromIstream(&delta_in)
+            || base.version() != delta.base_version()) {
+            return false;
+        }
+
+        //Готовая карта к обновлённому каталогу уже не подходит, её отрисуем заново по запросу
+        map_renderer.UpdateSettings(LoadRenderSettings(base.render_settings()));
+
+        if (IsAdditiveDelta(base.catalogue(), delta)) {
+            if (!LoadCatalogue(base.catalogue(), db)
+                || (base.has_router() && !LoadRouter(base.router(), db, transport_router))) {
+                return false;
+            }
+            return ApplyAdditiveDelta(delta, db, transport_router);
+        }
+
+        //Иначе номера остановок и автобусов меняются, и сохранённый граф уже не подходит
+        std::optional<proto::TransportCatalogue> catalogue = MergeDelta(base.catalogue(), delta);
+        if (!catalogue) {
+            return false;
+        }
+        if (!LoadCatalogue(*catalogue, db)) {
+            return false;
+        }
+
+        if (base.has_router()) {
+            transport_router.UpdateSettings({
+                    base.router().settings().bus_wait_time(),
+                    base.router().settings().bus_velocity()
+            });
+            transport_router.BuildGraph();
+        }
+
+        return true;
+    }
+
+} // namespace transport_catalogue::service
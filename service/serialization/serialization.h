@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "transport_catalogue/transport_catalogue.h"
+#include "service/map_renderer/map_renderer.h"
+#include "service/transport_router/transport_router.h"
+
+namespace transport_catalogue::service {
+
+    struct SerializationSettings {
+        std::string file;
+        std::string flat_file; // необязательная плоская копия каталога, см. flat_catalogue.h
+        std::string delta_file; // необязательное обновление базы
+    };
+
+    // Сохраняет каталог вместе с настройками отрисовки и маршрутизации в поток out
+    void SerializeBase(const TransportCatalogue& db, const MapRenderer& map_renderer,
+                       const TransportRouter& transport_router, std::ostream& out);
+
+    // Заполняет пустой каталог и сервисы из потока in. Возвращает false, если базу не удалось прочитать
+    bool DeserializeBase(std::istream& in, TransportCatalogue& db, MapRenderer& map_renderer,
+                         TransportRouter& transport_router);
+
+    // Версия базы - хэш содержимого каталога. Обновление применяется только к той версии, от которой построено
+    uint64_t ComputeBaseVersion(const TransportCatalogue& db);
+
+    // Записывает в поток out обновление, превращающее каталог old_db в new_db
+    void SerializeDelta(const TransportCatalogue& old_db, const TransportCatalogue& new_db, std::ostream& out);
+
+    // То же, что DeserializeBase, но сразу применяет к базе обновление из delta_in.
+    // Если обновление только добавляет объекты, граф маршрутизатора достраивается, а не строится заново.
+    // Тогда время маршрута может отличаться от полной перестройки на единицу последнего знака
+    // (относительно до ~1e-15), а из равных по времени маршрутов может быть выбран другой, см. Router::AddEdges
+    bool DeserializeBase(std::istream& in, std::istream& delta_in, TransportCatalogue& db,
+                         MapRenderer& map_renderer, TransportRouter& transport_router);
+
+} // namespace transport_catalogue::service
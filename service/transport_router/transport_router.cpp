@@ -6,16 +6,19 @@ using namespace std::literals;
 
 namespace transport_catalogue::service {
 
-    template<typename It>
-    size_t CountVertexes(It begin, It end) {
+    size_t CountVertexes(const TransportCatalogue& catalogue) {
         //Считаем именно через маршруты, чтобы исключить остановки, через которые не ходят автобусы
-        std::unordered_set<const domain::Stop*> uniq_stops;
-        for (It it = begin; it != end; ++it) {
-            for (const domain::Stop* stop : it->route) {
-                uniq_stops.insert(stop);
+        std::vector<bool> is_used(catalogue.GetStopCount(), false);
+        size_t uniq_stops = 0;
+        for (BusId bus = 0; bus < catalogue.GetBusCount(); ++bus) {
+            for (StopId stop : catalogue.GetBusRoute(bus)) {
+                if (!is_used[stop]) {
+                    is_used[stop] = true;
+                    ++uniq_stops;
+                }
             }
         }
-        return uniq_stops.size() * 2;
+        return uniq_stops * 2;
     }
 
     TransportRouter::TransportRouter(const TransportCatalogue& catalogue) : catalogue_(catalogue) {}
@@ -27,73 +30,135 @@ namespace transport_catalogue::service {
         settings_ = settings;
     }
 
+    const RouterSettings& TransportRouter::GetSettings() const {
+        return settings_;
+    }
+
     void TransportRouter::BuildGraph() {
-        const std::deque<domain::Bus>& buses = catalogue_.GetBuses();
-        graph_ = graph::DirectedWeightedGraph<double>(CountVertexes(buses.begin(), buses.end()));
-        for (const domain::Bus& bus : buses) {
+        graph_ = graph::DirectedWeightedGraph<double>(CountVertexes(catalogue_));
+        stop_to_hub_.assign(catalogue_.GetStopCount(), std::nullopt);
+        edge_to_info_.clear();
+        vertex_counter_ = 0;
+        for (BusId bus = 0; bus < catalogue_.GetBusCount(); ++bus) {
             AddBusRoute(bus);
         }
 
         router_ptr_ = std::make_unique<graph::Router<double>>(graph_);
     }
 
-    void TransportRouter::AddBusRoute(const domain::Bus& bus) {
+    void TransportRouter::AddBuses(size_t first_new_bus) {
+        const size_t bus_count = catalogue_.GetBusCount();
+        if (first_new_bus >= bus_count) {
+            return;
+        }
+        stop_to_hub_.resize(catalogue_.GetStopCount(), std::nullopt);
+
+        //Для остановок, через которые ещё не ходили автобусы, нужны новые хабы
+        std::unordered_set<StopId> new_stops;
+        for (BusId bus = first_new_bus; bus < bus_count; ++bus) {
+            for (StopId stop : catalogue_.GetBusRoute(bus)) {
+                if (!stop_to_hub_[stop]) {
+                    new_stops.insert(stop);
+                }
+            }
+        }
+        graph_.AddVertexes(new_stops.size() * 2);
+
+        const graph::EdgeId first_new_edge = graph_.GetEdgeCount();
+        for (BusId bus = first_new_bus; bus < bus_count; ++bus) {
+            AddBusRoute(bus);
+        }
+
+        router_ptr_->AddEdges(first_new_edge);
+    }
+
+    bool TransportRouter::IsGraphBuilt() const noexcept {
+        return router_ptr_ != nullptr;
+    }
+
+    const graph::DirectedWeightedGraph<double>& TransportRouter::GetGraph() const {
+        return graph_;
+    }
+
+    const graph::Router<double>& TransportRouter::GetRouter() const {
+        return *router_ptr_;
+    }
+
+    const std::vector<std::optional<graph::EdgeId>>& TransportRouter::GetStopHubs() const {
+        return stop_to_hub_;
+    }
+
+    const std::vector<EdgeInfo>& TransportRouter::GetEdgesInfo() const {
+        return edge_to_info_;
+    }
+
+    void TransportRouter::RestoreGraph(graph::DirectedWeightedGraph<double> graph,
+                                       std::vector<std::optional<graph::EdgeId>> stop_to_hub,
+                                       std::vector<EdgeInfo> edge_to_info,
+                                       graph::Router<double>::RoutesInternalData routes_internal_data) {
+        graph_ = std::move(graph);
+        stop_to_hub_ = std::move(stop_to_hub);
+        edge_to_info_ = std::move(edge_to_info);
+        vertex_counter_ = graph_.GetVertexCount();
+
+        router_ptr_ = std::make_unique<graph::Router<double>>(graph_, std::move(routes_internal_data));
+    }
+
+    void TransportRouter::AddBusRoute(BusId bus) {
         if (settings_.bus_velocity <= 0) {
             throw std::logic_error("invalid bus velocity: \""s + std::to_string(settings_.bus_velocity) + "\""s);
         }
-        size_t stops_count = bus.route.size();
+        const RouteRange route = catalogue_.GetBusRoute(bus);
+        size_t stops_count = route.size();
         if (stops_count == 0) {
             return;
         }
+        const bool is_one_way = catalogue_.GetBusType(bus) == domain::RouteType::ONE_WAY;
 
         for (size_t i = 0; i < stops_count - 1; ++i) {
             //Сначала нужно создать вершину остановки (или получить, если она уже была создана другим маршрутом)
-            const Stop* current_stop_ptr = bus.route.at(i);
-            graph::Edge current_hub = GetStopHub(current_stop_ptr);
+            StopId current_stop = route[i];
+            graph::Edge current_hub = GetStopHub(current_stop);
 
             //Тут её нужно слинковать с последующими
-            const Stop* temp_stop_ptr = current_stop_ptr; //промежуточная остановка для вычисления общего расстояния
-            double temp_distance = 0.0;
-            double temp_back_disatance = 0.0;
             for (size_t k = i + 1; k < stops_count; ++k) {
                 size_t span_count = k - i;
-                const Stop* next_stop_ptr = bus.route.at(k);
-                graph::Edge next_hub = GetStopHub(next_stop_ptr);
+                StopId next_stop = route[k];
+                graph::Edge next_hub = GetStopHub(next_stop);
 
                 // Функция создания ребра
-                static auto add_new_edge = [&](const Stop* from_stop_ptr, const Stop* to_stop_ptr,
-                        graph::Edge<double> source_hub, graph::Edge<double> dest_hub, double& temp_distance,
-                        const Stop* dest_stop_ptr) {
-                    //Вычисляем время поездки
-                    temp_distance += catalogue_.GetRealLength(from_stop_ptr, to_stop_ptr);
-                    double duration = temp_distance / (settings_.bus_velocity / 0.06);
+                auto add_new_edge = [&](size_t from_index, size_t to_index,
+                        graph::Edge<double> source_hub, graph::Edge<double> dest_hub, StopId dest_stop) {
+                    //Вычисляем время поездки, расстояние берём из префиксных сумм каталога
+                    double distance = catalogue_.GetRouteRealLength(bus, from_index, to_index);
+                    double duration = distance / (settings_.bus_velocity / 0.06);
 
                     //Создаём дугу поездки от source_hub.to до dest_hub.from
-                    //Созданную дугу нужно сразу добавить в контейнер с информацией о ней
-                    edge_to_info_[graph_.AddEdge({source_hub.to, dest_hub.from, duration})] = {
+                    //Информация о дуге лежит под тем же индексом, что и сама дуга
+                    graph_.AddEdge({source_hub.to, dest_hub.from, duration});
+                    edge_to_info_.push_back({
                             false,
                             duration,
                             span_count,
-                            &bus,
-                            dest_stop_ptr
-                    };
+                            bus,
+                            dest_stop
+                    });
                 };
 
-                add_new_edge(temp_stop_ptr, next_stop_ptr, current_hub, next_hub, temp_distance, next_stop_ptr);
+                add_new_edge(i, k, current_hub, next_hub, next_stop);
                 //А теперь то же самое, только наоборот в случае, если маршрут некольцевой
-                if (bus.type == domain::RouteType::ONE_WAY) {
-                    add_new_edge(next_stop_ptr, temp_stop_ptr, next_hub, current_hub, temp_back_disatance, current_stop_ptr);
+                if (is_one_way) {
+                    add_new_edge(k, i, next_hub, current_hub, current_stop);
                 }
-                temp_stop_ptr = next_stop_ptr;
             }
         }
     }
 
     //Возвращает хаб остановки. Если его нет, создаёт и возвращает
     //Более ёмкого названия пока не придумал, но вроде и это подходит
-    graph::Edge<double> TransportRouter::GetStopHub(const domain::Stop* stop) {
-        if (stop_to_hub_.count(stop) > 0) {
-            return graph_.GetEdge(stop_to_hub_.at(stop));
+    graph::Edge<double> TransportRouter::GetStopHub(StopId stop) {
+        if (stop_to_hub_[stop]) {
+            return graph_.GetEdge(*stop_to_hub_[stop]);
         }
 
         graph::Edge<double> new_edge = {
@@ -102,29 +167,30 @@ namespace transport_catalogue::service {
                 static_cast<double>(settings_.bus_wait_time)
         };
 
-        graph::EdgeId edge_id = stop_to_hub_[stop] = graph_.AddEdge(new_edge);
+        stop_to_hub_[stop] = graph_.AddEdge(new_edge);
 
-        edge_to_info_[edge_id] = {
+        edge_to_info_.push_back({
                 true,
                 static_cast<double>(settings_.bus_wait_time),
                 0,
-                nullptr,
+                0,
                 stop
-        };
+        });
 
         return new_edge;
     }
 
     std::optional<Route> TransportRouter::GetRoute(std::string_view from, std::string_view to) const {
-        const Stop* from_stop_ptr = catalogue_.GetStop(from);
-        const Stop* to_stop_ptr = catalogue_.GetStop(to);
+        std::optional<StopId> from_stop = catalogue_.FindStop(from);
+        std::optional<StopId> to_stop = catalogue_.FindStop(to);
 
-        if (from_stop_ptr == nullptr || to_stop_ptr == nullptr || stop_to_hub_.count(from_stop_ptr) == 0 || stop_to_hub_.count(to_stop_ptr) == 0) {
+        if (!from_stop || !to_stop || *from_stop >= stop_to_hub_.size() || *to_stop >= stop_to_hub_.size()
+            || !stop_to_hub_[*from_stop] || !stop_to_hub_[*to_stop]) {
             return std::nullopt;
         }
 
-        graph::VertexId from_vertex = graph_.GetEdge(stop_to_hub_.at(from_stop_ptr)).from;
-        graph::VertexId to_vertex = graph_.GetEdge(stop_to_hub_.at(to_stop_ptr)).from;
+        graph::VertexId from_vertex = graph_.GetEdge(*stop_to_hub_[*from_stop]).from;
+        graph::VertexId to_vertex = graph_.GetEdge(*stop_to_hub_[*to_stop]).from;
 
         std::optional<graph::Router<double>::RouteInfo> route = router_ptr_->BuildRoute(from_vertex, to_vertex);
 
@@ -138,7 +204,7 @@ namespace transport_catalogue::service {
         result.intervals.reserve(route->edges.size());
 
         for (graph::EdgeId edge_id : route->edges) {
-            result.intervals.push_back(edge_to_info_.at(edge_id));
+            result.intervals.push_back(edge_to_info_[edge_id]);
         }
 
         return result;
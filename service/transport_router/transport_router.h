@@ -1,8 +1,6 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
-#include <deque>
 #include <optional>
 #include <memory>
 
@@ -16,8 +14,8 @@ namespace transport_catalogue::service {
         bool is_waiting_edge = false;
         double duration = 0.0;
         size_t span_count = 0;
-        const domain::Bus* current_route = nullptr;
-        const domain::Stop* destination_stop = nullptr;
+        domain::BusId bus = 0; // только для ребра поездки
+        domain::StopId stop = 0;
     };
 
     struct Route {
@@ -35,24 +33,41 @@ namespace transport_catalogue::service {
         TransportRouter(const TransportCatalogue& catalogue);
         TransportRouter(RouterSettings settings, const TransportCatalogue& catalogue);
         void UpdateSettings(RouterSettings settings);
+        const RouterSettings& GetSettings() const;
         void BuildGraph();
+        // Достраивает уже построенный граф автобусами каталога, начиная с номера first_new_bus
+        void AddBuses(size_t first_new_bus);
+        bool IsGraphBuilt() const noexcept;
         std::optional<Route> GetRoute(std::string_view from, std::string_view to) const;
 
+        // Доступ к построенному графу и таблицам маршрутизатора для сериализации
+        const graph::DirectedWeightedGraph<double>& GetGraph() const;
+        const graph::Router<double>& GetRouter() const;
+        const std::vector<std::optional<graph::EdgeId>>& GetStopHubs() const;
+        const std::vector<EdgeInfo>& GetEdgesInfo() const;
+
+        // Восстанавливает готовый граф и маршрутизатор без пересчёта таблиц
+        void RestoreGraph(graph::DirectedWeightedGraph<double> graph,
+                          std::vector<std::optional<graph::EdgeId>> stop_to_hub,
+                          std::vector<EdgeInfo> edge_to_info,
+                          graph::Router<double>::RoutesInternalData routes_internal_data);
+
     private:
         RouterSettings settings_;
         const TransportCatalogue& catalogue_;
 
-        // Тут EdgeId выполняет роль хаба, где from - это A', а to - это A
-        std::unordered_map<const domain::Stop*, graph::EdgeId> stop_to_hub_;
-        std::unordered_map<graph::EdgeId, EdgeInfo> edge_to_info_;
+        // Тут EdgeId выполняет роль хаба, где from - это A', а to - это A. Индекс - StopId
+        std::vector<std::optional<graph::EdgeId>> stop_to_hub_;
+        // Индекс - EdgeId
+        std::vector<EdgeInfo> edge_to_info_;
 
         size_t vertex_counter_ = 0;
 
         graph::DirectedWeightedGraph<double> graph_;
         std::unique_ptr<graph::Router<double>> router_ptr_;
 
-        void AddBusRoute(const domain::Bus& from_stop_ptr);
-        graph::Edge<double> GetStopHub(const domain::Stop* stop);
+        void AddBusRoute(domain::BusId bus);
+        graph::Edge<double> GetStopHub(domain::StopId stop);
 
     };
 
@@ -84,6 +84,30 @@ namespace svg {
         return o;
     }
 
+    bool operator==(Rgb lhs, Rgb rhs) {
+        return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue;
+    }
+
+    bool operator!=(Rgb lhs, Rgb rhs) {
+        return !(lhs == rhs);
+    }
+
+    bool operator==(Rgba lhs, Rgba rhs) {
+        return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue && lhs.opacity == rhs.opacity;
+    }
+
+    bool operator!=(Rgba lhs, Rgba rhs) {
+        return !(lhs == rhs);
+    }
+
+    bool operator==(Point lhs, Point rhs) {
+        return lhs.x == rhs.x && lhs.y == rhs.y;
+    }
+
+    bool operator!=(Point lhs, Point rhs) {
+        return !(lhs == rhs);
+    }
+
     std::ostream& operator<<(std::ostream& o, const Color& color) {
         std::visit(detail::ColorPrinter{o}, color);
         return o;
@@ -41,6 +41,11 @@ namespace svg {
         };
     } //namespace detail
 
+    bool operator==(Rgb lhs, Rgb rhs);
+    bool operator!=(Rgb lhs, Rgb rhs);
+    bool operator==(Rgba lhs, Rgba rhs);
+    bool operator!=(Rgba lhs, Rgba rhs);
+
     using Color = std::variant<std::monostate, std::string, Rgb, Rgba>;
     inline const Color NoneColor{"none"};
 
@@ -56,6 +61,9 @@ namespace svg {
         double y = 0;
     };
 
+    bool operator==(Point lhs, Point rhs);
+    bool operator!=(Point lhs, Point rhs);
+
     enum class StrokeLineCap {
         BUTT,
         ROUND,
@@ -0,0 +1,147 @@
+#include "tests/test_framework.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace transport_catalogue::tests {
+
+    namespace {
+
+        // Каталог версии version: остановки от "Stop 0" до "Stop version" и автобус "Bus" через все
+        CatalogueSnapshot BuildVersion(size_t version) {
+            CatalogueBuilder builder;
+            TransportCatalogue& db = builder.GetCatalogue();
+            std::vector<std::string> names;
+            for (size_t i = 0; i <= version; ++i) {
+                names.push_back("Stop "s + std::to_string(i));
+                db.AddStop(names.back(), 55.6 + 0.001 * i, 37.6);
+            }
+            for (size_t i = 0; i < version; ++i) {
+                db.AddDistance(names[i], names[i + 1], 100);
+            }
+            db.AddBus("Bus"sv, {names.begin(), names.end()}, RouteType::ONE_WAY);
+            return builder.Build();
+        }
+
+        // Номер версии, если снимок согласован, иначе 0
+        size_t CheckVersion(const TransportCatalogue& db) {
+            const size_t version = db.GetStopCount() - 1;
+            const std::optional<BusId> bus = db.FindBus("Bus"sv);
+            if (version == 0 || !bus || db.GetRouteInfo(*bus).uniq_stops != version + 1
+                || !db.FindStop("Stop "s + std::to_string(version))
+                || db.FindStop("Stop "s + std::to_string(version + 1))
+                || db.GetStopBuses(static_cast<StopId>(version)).size() != 1) {
+                return 0;
+            }
+            return version;
+        }
+
+    } // namespace
+
+    void TestBuilderIsSingleUse() {
+        CatalogueBuilder builder;
+        builder.GetCatalogue().AddStop("A"sv, 55.6, 37.6);
+        const CatalogueSnapshot snapshot = builder.Build();
+        ASSERT_EQUAL(snapshot->GetStopCount(), 1u);
+        ASSERT(snapshot->FindStop("A"sv).has_value());
+
+        bool thrown = false;
+        try {
+            builder.GetCatalogue();
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+
+    void TestPinnedSnapshotOutlivesPublish() {
+        CataloguePublisher publisher(BuildVersion(1));
+        CatalogueSnapshot pinned = publisher.Pin();
+        const std::weak_ptr<const TransportCatalogue> old = pinned;
+
+        publisher.Publish(BuildVersion(2));
+        ASSERT_EQUAL(CheckVersion(*pinned), 1u);
+        ASSERT_EQUAL(CheckVersion(*publisher.Pin()), 2u);
+
+        //Снятый узел удаляется сразу, каталог живёт только в копии читателя
+        pinned.reset();
+        ASSERT(old.expired());
+    }
+
+    void TestEmptyPublisher() {
+        CataloguePublisher publisher;
+        ASSERT(publisher.Pin() == nullptr);
+        publisher.Publish(BuildVersion(1));
+        ASSERT_EQUAL(CheckVersion(*publisher.Pin()), 1u);
+    }
+
+    void TestConcurrentReadersAndWriter() {
+        constexpr size_t reader_count = 4;
+        constexpr size_t last_version = 300;
+
+        CataloguePublisher publisher(BuildVersion(1));
+        std::vector<std::weak_ptr<const TransportCatalogue>> published;
+        published.push_back(publisher.Pin());
+
+        std::atomic<bool> done{false};
+        std::atomic<size_t> errors{0};
+        std::atomic<size_t> reads{0};
+
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < reader_count; ++i) {
+            readers.emplace_back([&] {
+                size_t last_seen = 0;
+                while (!done.load()) {
+                    const CatalogueSnapshot snapshot = publisher.Pin();
+                    const size_t version = CheckVersion(*snapshot);
+                    //Версия согласована и не идёт назад
+                    if (version == 0 || version < last_seen) {
+                        errors.fetch_add(1);
+                    }
+                    last_seen = version;
+                    reads.fetch_add(1);
+                }
+            });
+        }
+
+        //Публикуем, когда читатели уже работают
+        while (reads.load() == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t version = 2; version <= last_version; ++version) {
+            CatalogueSnapshot snapshot = BuildVersion(version);
+            published.push_back(snapshot);
+            publisher.Publish(std::move(snapshot));
+        }
+        done.store(true);
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+
+        ASSERT_EQUAL(errors.load(), 0u);
+        ASSERT(reads.load() > 0);
+        //Все читатели вышли, значит все снятые каталоги уже удалены, без следующей публикации
+        for (size_t i = 0; i + 1 < published.size(); ++i) {
+            ASSERT(published[i].expired());
+        }
+        ASSERT_EQUAL(CheckVersion(*publisher.Pin()), last_version);
+    }
+
+} // namespace transport_catalogue::tests
+
+int main() {
+    using namespace transport_catalogue::tests;
+    RUN_TEST(TestBuilderIsSingleUse);
+    RUN_TEST(TestPinnedSnapshotOutlivesPublish);
+    RUN_TEST(TestEmptyPublisher);
+    RUN_TEST(TestConcurrentReadersAndWriter);
+    return FailedAsserts() == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include "tests/test_framework.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+#include "transport_catalogue/flat_catalogue.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace transport_catalogue::tests {
+
+    namespace {
+
+        const std::string FLAT_PATH = "flat_catalogue_test.flat"s;
+
+        // Три остановки, кольцевой и линейный автобусы
+        CatalogueSnapshot BuildCatalogue() {
+            CatalogueBuilder builder;
+            TransportCatalogue& db = builder.GetCatalogue();
+            db.AddStop("A"sv, 55.60, 37.60);
+            db.AddStop("B"sv, 55.61, 37.60);
+            db.AddStop("C"sv, 55.61, 37.62);
+            db.AddDistance("A"sv, "B"sv, 1200);
+            db.AddDistance("B"sv, "A"sv, 1300);
+            db.AddDistance("B"sv, "C"sv, 1500);
+            db.AddDistance("C"sv, "A"sv, 2100);
+            db.AddBus("ring"sv, {"A"sv, "B"sv, "C"sv, "A"sv}, RouteType::ROUND_TRIP);
+            db.AddBus("line"sv, {"A"sv, "B"sv, "C"sv}, RouteType::ONE_WAY);
+            return builder.Build();
+        }
+
+        std::string WriteToString(const TransportCatalogue& db) {
+            std::ostringstream out;
+            WriteFlatCatalogue(db, out);
+            return out.str();
+        }
+
+        void WriteFile(const std::string& content) {
+            std::ofstream out(FLAT_PATH, std::ios::binary);
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        }
+
+        // Подменяет значение по смещению offset в копии файла
+        template <typename T>
+        std::string Patch(std::string content, uint64_t offset, T value) {
+            std::memcpy(content.data() + offset, &value, sizeof(value));
+            return content;
+        }
+
+        bool IsRejected(const std::string& content) {
+            WriteFile(content);
+            try {
+                FlatCatalogue db(FLAT_PATH);
+            } catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        }
+
+    } // namespace
+
+    void TestRouteInfoIsStored() {
+        const CatalogueSnapshot db = BuildCatalogue();
+        WriteFile(WriteToString(*db));
+        const FlatCatalogue flat_db(FLAT_PATH);
+
+        for (std::string_view name : {"ring"sv, "line"sv}) {
+            const RouteInfo expected = db->GetRouteInfo(name);
+            const RouteInfo loaded = flat_db.GetRouteInfo(name);
+            ASSERT_EQUAL(loaded.total_stops, expected.total_stops);
+            ASSERT_EQUAL(loaded.uniq_stops, expected.uniq_stops);
+            ASSERT_EQUAL(loaded.real_length, expected.real_length);
+            ASSERT_EQUAL(loaded.curvature, expected.curvature);
+        }
+        ASSERT_EQUAL(flat_db.GetRouteInfo("line"sv).real_length, 1200 + 1500 + 1500 + 1300);
+        ASSERT(!flat_db.IsBusExists("tram"sv));
+
+        const auto buses = flat_db.GetStopBuses("B"sv);
+        ASSERT((std::vector<std::string_view>{buses.begin(), buses.end()}
+                == std::vector<std::string_view>{"line"sv, "ring"sv}));
+    }
+
+    void TestCorruptedRecordsAreRejected() {
+        const CatalogueSnapshot db = BuildCatalogue();
+        const std::string content = WriteToString(*db);
+        flat::Header header{};
+        std::memcpy(&header, content.data(), sizeof(header));
+
+        ASSERT(!IsRejected(content));
+        ASSERT(IsRejected(content.substr(0, content.size() / 2)));
+        ASSERT(IsRejected(Patch(content, header.stops_offset + offsetof(flat::Stop, name_offset),
+                                static_cast<uint32_t>(header.names_size))));
+        ASSERT(IsRejected(Patch(content, header.stops_offset + offsetof(flat::Stop, buses_end),
+                                header.stop_bus_count + 1)));
+        ASSERT(IsRejected(Patch(content, header.buses_offset + offsetof(flat::Bus, name_size),
+                                static_cast<uint32_t>(header.names_size + 1))));
+        ASSERT(IsRejected(Patch(content, header.stop_index_offset, header.stop_count)));
+        ASSERT(IsRejected(Patch(content, header.bus_index_offset, header.bus_count)));
+        ASSERT(IsRejected(Patch(content, header.stop_buses_offset, header.bus_count)));
+        std::remove(FLAT_PATH.c_str());
+    }
+
+} // namespace transport_catalogue::tests
+
+int main() {
+    using namespace transport_catalogue::tests;
+    RUN_TEST(TestRouteInfoIsStored);
+    RUN_TEST(TestCorruptedRecordsAreRejected);
+    return FailedAsserts() == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#include "tests/test_framework.h"
+#include "json/json.h"
+
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace transport_catalogue::tests {
+
+    namespace {
+
+        // Обработчик, которому события не нужны: проверяется только синтаксис
+        class IgnoreEvents : public json::EventHandler {
+        public:
+            void OnNull() override {}
+            void OnBool(bool) override {}
+            void OnInt(int) override {}
+            void OnDouble(double) override {}
+            void OnString(std::string_view) override {}
+            void OnKey(std::string_view) override {}
+            void OnStartArray() override {}
+            void OnEndArray() override {}
+            void OnStartDict() override {}
+            void OnEndDict() override {}
+        };
+
+        // Текст ошибки Load или пустая строка, если текст разобрался
+        std::string LoadError(std::string_view text) {
+            try {
+                json::Load(text);
+            } catch (const json::ParsingError& error) {
+                return error.what();
+            }
+            return {};
+        }
+
+        std::string ParseError(std::string_view text) {
+            IgnoreEvents handler;
+            try {
+                json::Parse(text, handler);
+            } catch (const json::ParsingError& error) {
+                return error.what();
+            }
+            return {};
+        }
+
+        // Словарь с ключами k0..k<count - 1> и значениями-числами, после них пары extra
+        std::string MakeDict(size_t count, std::string_view extra = {}) {
+            std::string text = "{"s;
+            for (size_t i = 0; i < count; ++i) {
+                text += "\"k"s + std::to_string(i) + "\": "s + std::to_string(i) + ", "s;
+            }
+            text += extra;
+            text += "\"end\": 0}"s;
+            return text;
+        }
+
+        // Load и потоковый Parse должны сообщать об одной и той же ошибке
+        void AssertError(std::string_view text, const std::string& expected) {
+            ASSERT_EQUAL(LoadError(text), expected);
+            ASSERT_EQUAL(ParseError(text), expected);
+        }
+
+    } // namespace
+
+    void TestTruncatedArray() {
+        AssertError("["sv, "Failed attempt to parse Array! There is no end bracket"s);
+        AssertError("[1"sv, "Failed attempt to parse Array! There is no end bracket"s);
+        AssertError("[1,2"sv, "Failed attempt to parse Array! There is no end bracket"s);
+        AssertError("[1,2,"sv, "A digit is expected"s);
+        AssertError("[1,2, "sv, "A digit is expected"s);
+        AssertError("[1,-"sv, "A digit is expected"s);
+        AssertError("[1.5e"sv, "A digit is expected"s);
+        AssertError("[\"abc"sv, "Failed attempt to parse string! There is no end quote"s);
+        AssertError("[tr"sv, "Failed attempt to parse \"tr\" as bool!"s);
+        AssertError("[[1],[2"sv, "Failed attempt to parse Array! There is no end bracket"s);
+    }
+
+    void TestTruncatedDict() {
+        AssertError("{"sv, "Failed attempt to parse Dictionary! There is no end bracket"s);
+        AssertError("{\"k\""sv, "Failed attempt to parse Dictionary! There is no colon between key and value"s);
+        AssertError("{\"k\":"sv, "A digit is expected"s);
+        AssertError("{\"k\":1"sv, "Failed attempt to parse Dictionary! There is no end bracket"s);
+        AssertError("{\"k\":\"v\\\\\","sv,
+                    "Failed attempt to parse Dictionary! Invalid key format. A string is expected"s);
+        AssertError("{\"k\":\"v\\\\\", "sv,
+                    "Failed attempt to parse Dictionary! Invalid key format. A string is expected"s);
+        AssertError("{\"k\":\"v\\\""sv, "Failed attempt to parse string! There is no end quote"s);
+        AssertError("{\"k\":{\"a\":[1"sv, "Failed attempt to parse Array! There is no end bracket"s);
+    }
+
+    void TestEmptyInput() {
+        AssertError(""sv, "A digit is expected"s);
+        AssertError("  "sv, "A digit is expected"s);
+    }
+
+    void TestCompleteInput() {
+        AssertError("[1,2,3]"sv, ""s);
+        AssertError("{\"k\":\"v\\\\\",\"x\":[true,false,null]}"sv, ""s);
+        const json::Document doc = json::Load("{\"k\": [1, 2.5, \"s\"]}"sv);
+        const json::Array& items = doc.GetRoot().AsMap().at("k"s).AsArray();
+        ASSERT_EQUAL(items.size(), 3u);
+        ASSERT_EQUAL(items[0].AsInt(), 1);
+        ASSERT_EQUAL(items[1].AsDouble(), 2.5);
+        ASSERT_EQUAL(items[2].AsString(), "s"sv);
+    }
+
+    void TestNestedBigDicts() {
+        //Во вложенном словаре могут повторяться ключи внешнего, даже когда оба большие
+        const std::string text = MakeDict(20, "\"inner\": "s + MakeDict(20) + ", "s);
+        ASSERT_EQUAL(LoadError(text), ""s);
+        const json::Document doc = json::Load(text);
+        const json::Dict& outer = doc.GetRoot().AsMap();
+        ASSERT_EQUAL(outer.size(), 22u);
+        ASSERT_EQUAL(outer.at("k16"sv).AsInt(), 16);
+        const json::Dict& inner = outer.at("inner"sv).AsMap();
+        ASSERT_EQUAL(inner.size(), 21u);
+        ASSERT_EQUAL(inner.at("k19"sv).AsInt(), 19);
+
+        //После закрытия вложенного словаря повторы во внешнем по-прежнему находятся
+        ASSERT_EQUAL(LoadError(MakeDict(20, "\"inner\": "s + MakeDict(20) + ", \"k16\": 1, "s)),
+                     "Failed attempt to parse Dictionary! Duplicate key \"k16\" have been found"s);
+        ASSERT_EQUAL(LoadError(MakeDict(20, "\"inner\": "s + MakeDict(20, "\"k3\": 1, "sv) + ", "s)),
+                     "Failed attempt to parse Dictionary! Duplicate key \"k3\" have been found"s);
+    }
+
+} // namespace transport_catalogue::tests
+
+int main() {
+    using namespace transport_catalogue::tests;
+    RUN_TEST(TestTruncatedArray);
+    RUN_TEST(TestTruncatedDict);
+    RUN_TEST(TestEmptyInput);
+    RUN_TEST(TestCompleteInput);
+    RUN_TEST(TestNestedBigDicts);
+    return FailedAsserts() == 0 ? 0 : 1;
+}
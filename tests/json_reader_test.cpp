@@ -0,0 +1,129 @@
+#include "tests/test_framework.h"
+#include "service/json_reader/json_reader.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std::literals;
+
+namespace transport_catalogue::tests {
+
+    namespace {
+
+        // Остановки A и second, автобус bus между ними, запросы Stop к A и к C
+        std::string MakeInput(std::string_view second, std::string_view bus) {
+            std::ostringstream out;
+            out << R"({"base_requests": [)"
+                << R"({"type": "Stop", "name": "A", "latitude": 55.6, "longitude": 37.6, "road_distances": {")"
+                << second << R"(": 1000}},)"
+                << R"({"type": "Stop", "name": ")" << second
+                << R"(", "latitude": 55.61, "longitude": 37.6, "road_distances": {}},)"
+                << R"({"type": "Bus", "name": ")" << bus << R"(", "stops": ["A", ")" << second
+                << R"("], "is_roundtrip": false}],)"
+                << R"("stat_requests": [{"id": 1, "type": "Stop", "name": "A"}, {"id": 2, "type": "Stop", "name": "C"}]})";
+            return out.str();
+        }
+
+        // Текст исключения, брошенного при чтении и заполнении каталога, или пустая строка
+        std::string FillError(std::string_view input) {
+            CataloguePublisher publisher;
+            service::JsonReader reader(publisher);
+            std::istringstream in{std::string(input)};
+            try {
+                reader.ReadJson(in);
+                reader.FillCatalogue();
+            } catch (const std::logic_error& error) {
+                return error.what();
+            }
+            return {};
+        }
+
+        std::string GetStats(const service::JsonReader& reader) {
+            std::ostringstream out;
+            reader.GetStats(out);
+            return out.str();
+        }
+
+    } // namespace
+
+    void TestFillCataloguePublishes() {
+        CataloguePublisher publisher;
+        service::JsonReader reader(publisher);
+        std::istringstream in(MakeInput("B"sv, "1"sv));
+        reader.ReadJson(in);
+        reader.FillCatalogue();
+
+        const CatalogueSnapshot db = publisher.Pin();
+        ASSERT(db != nullptr);
+        ASSERT_EQUAL(db->GetStopCount(), 2u);
+        ASSERT(db->FindBus("1"sv).has_value());
+        ASSERT_EQUAL(GetStats(reader),
+                     R"([{"buses": ["1"], "request_id": 1}, {"error_message": "not found", "request_id": 2}])"s);
+    }
+
+    void TestStatsFollowPublishedSnapshot() {
+        CataloguePublisher publisher;
+        service::JsonReader reader(publisher);
+        std::istringstream in(MakeInput("B"sv, "1"sv));
+        reader.ReadJson(in);
+        reader.FillCatalogue();
+        const CatalogueSnapshot old_db = publisher.Pin();
+
+        //Другой писатель подменяет каталог. Запросы идут уже к новому снимку
+        service::JsonReader writer(publisher);
+        std::istringstream new_in(MakeInput("C"sv, "2"sv));
+        writer.ReadJson(new_in);
+        writer.FillCatalogue();
+        ASSERT_EQUAL(GetStats(reader),
+                     R"([{"buses": ["2"], "request_id": 1}, {"buses": ["2"], "request_id": 2}])"s);
+
+        //Закреплённый раньше снимок не изменился
+        ASSERT(old_db->FindBus("1"sv).has_value());
+        ASSERT(!old_db->FindBus("2"sv).has_value());
+    }
+
+    void TestUnreadFieldsMayHaveAnyType() {
+        //Поля, которые запрос такого типа не читает, не проверяются, как и при разборе дерева
+        std::istringstream in(R"({"base_requests": [)"
+                              R"({"type": "Stop", "name": "A", "latitude": 55.6, "longitude": 37.6,)"
+                              R"( "stops": 5, "is_roundtrip": "yes"},)"
+                              R"({"type": "Bus", "name": "1", "stops": ["A"], "is_roundtrip": true,)"
+                              R"( "latitude": "x", "road_distances": {"A": "far", "B": [1]}}],)"
+                              R"("stat_requests": [{"id": 1, "type": "Stop", "name": "A", "count": "x", "from": [1]},)"
+                              R"({"id": 2, "type": "Unknown", "name": 5, "to": {"a": 1}}]})");
+        CataloguePublisher publisher;
+        service::JsonReader reader(publisher);
+        reader.ReadJson(in);
+        reader.FillCatalogue();
+        ASSERT_EQUAL(GetStats(reader), R"([{"buses": ["1"], "request_id": 1}])"s);
+    }
+
+    void TestReadFieldsMustHaveTheirType() {
+        ASSERT_EQUAL(FillError(R"({"base_requests": [{"type": "Stop", "name": 5, "latitude": 1, "longitude": 1}]})"sv),
+                     "Failed attempt to parse node as string!"s);
+        ASSERT_EQUAL(FillError(R"({"base_requests": [{"type": "Stop", "name": "A", "latitude": "1", "longitude": 1}]})"sv),
+                     "Failed attempt to parse node as double!"s);
+        ASSERT_EQUAL(FillError(R"({"base_requests": [{"type": "Stop", "name": "A", "latitude": 1, "longitude": 1,)"
+                               R"( "road_distances": {"B": 1.5}}]})"sv),
+                     "Failed attempt to parse node as int!"s);
+        ASSERT_EQUAL(FillError(R"({"base_requests": [{"type": "Bus", "name": "1", "stops": ["A", 2],)"
+                               R"( "is_roundtrip": false}]})"sv),
+                     "Failed attempt to parse node as string!"s);
+        ASSERT_EQUAL(FillError(R"({"stat_requests": [{"id": "1", "type": "Map"}]})"sv),
+                     "Failed attempt to parse node as int!"s);
+        ASSERT_EQUAL(FillError(R"({"stat_requests": [{"id": 1, "type": "Bus", "name": null}]})"sv),
+                     "Failed attempt to parse node as string!"s);
+    }
+
+} // namespace transport_catalogue::tests
+
+int main() {
+    using namespace transport_catalogue::tests;
+    RUN_TEST(TestFillCataloguePublishes);
+    RUN_TEST(TestStatsFollowPublishedSnapshot);
+    RUN_TEST(TestUnreadFieldsMayHaveAnyType);
+    RUN_TEST(TestReadFieldsMustHaveTheirType);
+    return FailedAsserts() == 0 ? 0 : 1;
+}
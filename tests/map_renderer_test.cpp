@@ -0,0 +1,72 @@
+#include "tests/test_framework.h"
+#include "service/map_renderer/map_renderer.h"
+#include "transport_catalogue/catalogue_snapshot.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std::literals;
+
+namespace transport_catalogue::tests {
+
+    namespace {
+
+        const std::string STORED_MAP = "<stored map/>"s;
+
+        service::RenderSettings MakeSettings() {
+            service::RenderSettings settings;
+            settings.width = 600.0;
+            settings.height = 400.0;
+            settings.padding = 50.0;
+            settings.line_width = 14.0;
+            settings.stop_radius = 5.0;
+            settings.bus_label_font_size = 20;
+            settings.bus_label_offsets = {7.0, 15.0};
+            settings.stop_label_font_size = 18;
+            settings.stop_label_offsets = {7.0, -3.0};
+            settings.underlayer_color = svg::Rgba{255, 255, 255, 0.85};
+            settings.underlayer_width = 3.0;
+            settings.color_palette = {"green"s, svg::Rgb{255, 160, 0}, "red"s};
+            return settings;
+        }
+
+        std::string Render(const service::MapRenderer& renderer, const TransportCatalogue& db) {
+            std::ostringstream out;
+            renderer.Render(db, out);
+            return out.str();
+        }
+
+    } // namespace
+
+    void TestStoredMapNeedsEqualSettings() {
+        CatalogueBuilder builder;
+        TransportCatalogue& db = builder.GetCatalogue();
+        db.AddStop("A"sv, 55.60, 37.60);
+        db.AddStop("B"sv, 55.61, 37.62);
+        db.AddBus("1"sv, {"A"sv, "B"sv}, RouteType::ONE_WAY);
+        const CatalogueSnapshot snapshot = builder.Build();
+
+        service::MapRenderer renderer(MakeSettings());
+        renderer.SetRenderedMap(STORED_MAP);
+        ASSERT_EQUAL(Render(renderer, *snapshot), STORED_MAP);
+
+        //Любое отличие в настройках, даже в одном цвете палитры, требует отрисовать карту заново
+        service::RenderSettings changed = MakeSettings();
+        changed.color_palette[1] = svg::Rgb{255, 160, 1};
+        renderer.UpdateSettings(changed);
+        const std::string rendered = Render(renderer, *snapshot);
+        ASSERT(rendered != STORED_MAP);
+        ASSERT(rendered.find("<svg"s) != std::string::npos);
+
+        //Те же настройки, заданные заново, снова подходят к сохранённой карте
+        renderer.UpdateSettings(MakeSettings());
+        ASSERT_EQUAL(Render(renderer, *snapshot), STORED_MAP);
+    }
+
+} // namespace transport_catalogue::tests
+
+int main() {
+    using namespace transport_catalogue::tests;
+    RUN_TEST(TestStoredMapNeedsEqualSettings);
+    return FailedAsserts() == 0 ? 0 : 1;
+}
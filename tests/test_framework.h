@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+namespace transport_catalogue::tests {
+
+    // Сколько проверок не прошло с начала запуска. Тест после провала продолжается, итог подводит main
+    inline int& FailedAsserts() {
+        static int failed = 0;
+        return failed;
+    }
+
+    inline void AssertImpl(bool value, const std::string& expr_str, const std::string& file, unsigned line) {
+        if (!value) {
+            std::cerr << file << "(" << line << "): ASSERT(" << expr_str << ") failed\n";
+            ++FailedAsserts();
+        }
+    }
+
+    template <typename T, typename U>
+    void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str,
+                         const std::string& file, unsigned line) {
+        if (!(t == u)) {
+            std::cerr << file << "(" << line << "): ASSERT_EQUAL(" << t_str << ", " << u_str << ") failed: "
+                      << t << " != " << u << '\n';
+            ++FailedAsserts();
+        }
+    }
+
+    template <typename TestFunc>
+    void RunTestImpl(TestFunc func, const std::string& test_name) {
+        const int failed_before = FailedAsserts();
+        func();
+        std::cerr << test_name << (FailedAsserts() == failed_before ? " OK\n" : " FAILED\n");
+    }
+
+} // namespace transport_catalogue::tests
+
+#define ASSERT(expr) ::transport_catalogue::tests::AssertImpl(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+#define ASSERT_EQUAL(a, b) ::transport_catalogue::tests::AssertEqualImpl((a), (b), #a, #b, __FILE__, __LINE__)
+
+#define RUN_TEST(func) ::transport_catalogue::tests::RunTestImpl((func), #func)
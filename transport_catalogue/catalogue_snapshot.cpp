@@ -0,0 +1,115 @@
+#include "catalogue_snapshot.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::literals;
+
+namespace transport_catalogue {
+
+    CatalogueBuilder::CatalogueBuilder()
+        : catalogue_(std::make_unique<TransportCatalogue>()) {
+    }
+
+    TransportCatalogue& CatalogueBuilder::GetCatalogue() {
+        if (!catalogue_) {
+            throw std::logic_error("catalogue is already built"s);
+        }
+        return *catalogue_;
+    }
+
+    CatalogueSnapshot CatalogueBuilder::Build() {
+        GetCatalogue().Finalize();
+        return CatalogueSnapshot(std::move(catalogue_));
+    }
+
+    CataloguePublisher::CataloguePublisher(CatalogueSnapshot initial)
+        : current_(new Node{std::move(initial)}) {
+    }
+
+    CataloguePublisher::~CataloguePublisher() {
+        delete current_.load();
+        for (const Node* node : retired_) {
+            delete node;
+        }
+        for (HazardSlot* slot = slots_.load(); slot != nullptr;) {
+            HazardSlot* next = slot->next;
+            delete slot;
+            slot = next;
+        }
+    }
+
+    CatalogueSnapshot CataloguePublisher::Pin() const {
+        HazardSlot& slot = AcquireSlot();
+        //Узел защищён, только если после записи в ячейку он всё ещё текущий:
+        //иначе публикатор мог успеть снять его и не увидеть нашу запись
+        const Node* node = current_.load();
+        while (true) {
+            slot.node.store(node);
+            const Node* current = current_.load();
+            if (current == node) {
+                break;
+            }
+            node = current;
+        }
+        CatalogueSnapshot snapshot = node->snapshot;
+        slot.node.store(nullptr);
+        slot.in_use.store(false);
+
+        //Publish выставляет флаг до обхода ячеек, а мы читаем его после очистки своей.
+        //Либо публикатор не увидел нашу защиту и уже удалил узел, либо мы видим флаг и удаляем его сами
+        if (has_retired_.load()) {
+            std::lock_guard guard(publish_mutex_);
+            Reclaim();
+        }
+        return snapshot;
+    }
+
+    void CataloguePublisher::Publish(CatalogueSnapshot snapshot) {
+        const Node* node = new Node{std::move(snapshot)};
+        std::lock_guard guard(publish_mutex_);
+        retired_.push_back(current_.exchange(node));
+        has_retired_.store(true);
+        Reclaim();
+    }
+
+    CataloguePublisher::HazardSlot& CataloguePublisher::AcquireSlot() const {
+        for (HazardSlot* slot = slots_.load(); slot != nullptr; slot = slot->next) {
+            bool expected = false;
+            if (!slot->in_use.load() && slot->in_use.compare_exchange_strong(expected, true)) {
+                return *slot;
+            }
+        }
+        //Свободных нет: ячеек столько, сколько читателей одновременно бывало внутри Pin
+        HazardSlot* slot = new HazardSlot;
+        slot->in_use.store(true);
+        slot->next = slots_.load();
+        while (!slots_.compare_exchange_weak(slot->next, slot)) {
+        }
+        return *slot;
+    }
+
+    void CataloguePublisher::Reclaim() const {
+        std::vector<const Node*> hazards;
+        for (HazardSlot* slot = slots_.load(); slot != nullptr; slot = slot->next) {
+            if (const Node* node = slot->node.load()) {
+                hazards.push_back(node);
+            }
+        }
+        auto is_protected = [&hazards](const Node* node) {
+            return std::find(hazards.begin(), hazards.end(), node) != hazards.end();
+        };
+
+        auto kept = retired_.begin();
+        for (const Node* node : retired_) {
+            if (is_protected(node)) {
+                *kept++ = node;
+            } else {
+                delete node;
+            }
+        }
+        retired_.erase(kept, retired_.end());
+        has_retired_.store(!retired_.empty());
+    }
+
+} //namespace transport_catalogue
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "transport_catalogue.h"
+
+namespace transport_catalogue {
+
+    // Неизменяемый каталог. Живёт, пока на него ссылается хоть один читатель или публикатор
+    using CatalogueSnapshot = std::shared_ptr<const TransportCatalogue>;
+
+    /*
+     * Собирает новый каталог, пока читатели работают со старым.
+     * Заполнение идёт через GetCatalogue, Build завершает каталог и отдаёт его как снимок
+     */
+    class CatalogueBuilder {
+    public:
+        CatalogueBuilder();
+
+        TransportCatalogue& GetCatalogue();
+
+        // Вызывает Finalize и превращает каталог в снимок. После вызова строитель пуст
+        CatalogueSnapshot Build();
+
+    private:
+        std::unique_ptr<TransportCatalogue> catalogue_;
+    };
+
+    /*
+     * Текущий снимок каталога, который можно подменять на лету в стиле RCU.
+     * Pin не берёт блокировок, пока нет снятых с публикации узлов: читатель занимает ячейку-защиту (hazard slot),
+     * записывает в неё прочитанный узел, копирует shared_ptr и освобождает ячейку.
+     * Publish подменяет указатель атомарно и сразу удаляет старые узлы, которые не записаны ни в одной ячейке.
+     * Защищённый узел удаляет последний читатель, который мог его видеть: выходя из Pin, он замечает
+     * ожидающие узлы и зовёт Reclaim под мьютексом. Запросы, успевшие закрепить старый снимок,
+     * дорабатывают с ним, каталог удалится вместе с последней копией.
+     * Публикаторы упорядочиваются мьютексом между собой
+     */
+    class CataloguePublisher {
+    public:
+        explicit CataloguePublisher(CatalogueSnapshot initial = nullptr);
+        ~CataloguePublisher();
+
+        // Закрепляет текущий снимок. Вызывается из любого потока
+        CatalogueSnapshot Pin() const;
+
+        // Делает snapshot текущим
+        void Publish(CatalogueSnapshot snapshot);
+
+        CataloguePublisher(const CataloguePublisher&) = delete;
+        CataloguePublisher& operator=(const CataloguePublisher&) = delete;
+
+    private:
+        struct Node {
+            CatalogueSnapshot snapshot;
+        };
+
+        // Узел, который читатель прочитал и ещё копирует. Ячейки только добавляются и живут до деструктора
+        struct alignas(64) HazardSlot {
+            std::atomic<const Node*> node{nullptr};
+            std::atomic<bool> in_use{false};
+            HazardSlot* next = nullptr;
+        };
+
+        std::atomic<const Node*> current_;
+        mutable std::atomic<HazardSlot*> slots_{nullptr};
+
+        mutable std::mutex publish_mutex_;
+        // Снятые с публикации узлы, которые читатель ещё мог успеть прочитать
+        mutable std::vector<const Node*> retired_;
+        // Есть ли что-то в retired_. Читатели смотрят сюда, не беря мьютекс
+        mutable std::atomic<bool> has_retired_{false};
+
+        // Занимает свободную ячейку или добавляет новую
+        HazardSlot& AcquireSlot() const;
+        // Удаляет снятые узлы, которых нет ни в одной ячейке. Вызывается под publish_mutex_
+        void Reclaim() const;
+    };
+
+} //namespace transport_catalogue
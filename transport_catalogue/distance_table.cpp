@@ -0,0 +1,96 @@
+#include "distance_table.h"
+
+namespace transport_catalogue {
+
+    namespace {
+
+        //Финальное перемешивание из MurmurHash3: соседние номера остановок расходятся по всей таблице
+        uint64_t Mix(uint64_t key) {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdull;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ull;
+            key ^= key >> 33;
+            return key;
+        }
+
+        constexpr size_t MIN_SLOT_COUNT = 16;
+
+    } // namespace
+
+    void DistanceTable::Set(domain::StopId from, domain::StopId to, int length) {
+        if (!Insert(from, to, length)) {
+            slots_[FindSlot(MakeKey(from, to))].length = length;
+        }
+    }
+
+    bool DistanceTable::Insert(domain::StopId from, domain::StopId to, int length) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            Rehash(slots_.empty() ? MIN_SLOT_COUNT : slots_.size() * 2);
+        }
+
+        const uint64_t key = MakeKey(from, to);
+        Slot& slot = slots_[FindSlot(key)];
+        if (slot.key == key) {
+            return false;
+        }
+        slot = {key, length};
+        ++size_;
+        return true;
+    }
+
+    const int* DistanceTable::Find(domain::StopId from, domain::StopId to) const {
+        if (slots_.empty()) {
+            return nullptr;
+        }
+        const Slot& slot = slots_[FindSlot(MakeKey(from, to))];
+        return slot.key == EMPTY_KEY ? nullptr : &slot.length;
+    }
+
+    size_t DistanceTable::size() const noexcept {
+        return size_;
+    }
+
+    void DistanceTable::reserve(size_t count) {
+        size_t slot_count = MIN_SLOT_COUNT;
+        while (slot_count < count * 2) {
+            slot_count *= 2;
+        }
+        if (slot_count > slots_.size()) {
+            Rehash(slot_count);
+        }
+    }
+
+    DistanceTable::Iterator DistanceTable::begin() const {
+        return {slots_.data(), slots_.data() + slots_.size()};
+    }
+
+    DistanceTable::Iterator DistanceTable::end() const {
+        return {slots_.data() + slots_.size(), slots_.data() + slots_.size()};
+    }
+
+    uint64_t DistanceTable::MakeKey(domain::StopId from, domain::StopId to) {
+        return (static_cast<uint64_t>(from) << 32) | to;
+    }
+
+    size_t DistanceTable::FindSlot(uint64_t key) const {
+        //Размер таблицы - степень двойки, поэтому вместо деления берём маску
+        const size_t mask = slots_.size() - 1;
+        size_t index = Mix(key) & mask;
+        while (slots_[index].key != key && slots_[index].key != EMPTY_KEY) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void DistanceTable::Rehash(size_t slot_count) {
+        std::vector<Slot> old_slots(slot_count, Slot{EMPTY_KEY, 0});
+        old_slots.swap(slots_);
+        for (const Slot& slot : old_slots) {
+            if (slot.key != EMPTY_KEY) {
+                slots_[FindSlot(slot.key)] = slot;
+            }
+        }
+    }
+
+} //namespace transport_catalogue
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "domain.h"
+
+namespace transport_catalogue {
+
+    /*
+     * Таблица дорожных расстояний между остановками.
+     * Хэш-таблица с открытой адресацией и линейным пробированием, ключ - пара номеров остановок в одном uint64_t.
+     * Заполненность держится не выше половины, поэтому поиск обычно укладывается в одно обращение к памяти
+     */
+    class DistanceTable {
+    private:
+        struct Slot {
+            uint64_t key;
+            int length;
+        };
+
+    public:
+        using value_type = std::pair<std::pair<domain::StopId, domain::StopId>, int>;
+
+        // Итератор по заполненным ячейкам, порядок обхода не определён
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = DistanceTable::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type*;
+            using reference = value_type;
+
+            Iterator(const Slot* slot, const Slot* end) : slot_(slot), end_(end) {
+                SkipEmpty();
+            }
+
+            value_type operator*() const {
+                return {{static_cast<domain::StopId>(slot_->key >> 32), static_cast<domain::StopId>(slot_->key)},
+                        slot_->length};
+            }
+
+            Iterator& operator++() {
+                ++slot_;
+                SkipEmpty();
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return slot_ == other.slot_;
+            }
+
+            bool operator!=(const Iterator& other) const {
+                return !(*this == other);
+            }
+
+        private:
+            const Slot* slot_;
+            const Slot* end_;
+
+            void SkipEmpty() {
+                while (slot_ != end_ && slot_->key == EMPTY_KEY) {
+                    ++slot_;
+                }
+            }
+        };
+
+        DistanceTable() = default;
+
+        // Записывает расстояние, перезаписывая старое
+        void Set(domain::StopId from, domain::StopId to, int length);
+        // Записывает расстояние, только если его ещё нет. Возвращает true, если записало
+        bool Insert(domain::StopId from, domain::StopId to, int length);
+        // Возвращает указатель на расстояние или nullptr, если его нет
+        const int* Find(domain::StopId from, domain::StopId to) const;
+
+        size_t size() const noexcept;
+        void reserve(size_t count);
+
+        Iterator begin() const;
+        Iterator end() const;
+
+    private:
+        static constexpr uint64_t EMPTY_KEY = ~uint64_t{0};
+
+        std::vector<Slot> slots_;
+        size_t size_ = 0;
+
+        static uint64_t MakeKey(domain::StopId from, domain::StopId to);
+        // Индекс ячейки с ключом key или пустой ячейки, где он должен лежать. Таблица не должна быть пустой
+        size_t FindSlot(uint64_t key) const;
+        void Rehash(size_t slot_count);
+    };
+
+} //namespace transport_catalogue
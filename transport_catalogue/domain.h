@@ -1,29 +1,38 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "geo/geo.h"
 
 namespace transport_catalogue::domain {
 
+    // Плотные номера остановок и автобусов в порядке добавления в каталог
+    using StopId = uint32_t;
+    using BusId = uint32_t;
+
     enum class RouteType {
         ROUND_TRIP,
         ONE_WAY
     };
 
-    struct Stop {
-        Stop(std::string_view stop_name, double latitude, double longtitude);
-
-        std::string name;
+    // Описания объектов для пакетной загрузки каталога. Названия должны жить до конца загрузки
+    struct StopDescription {
+        std::string_view name;
         geo::Coordinates coords;
     };
 
-    struct Bus {
-        Bus(std::string_view bus_name, std::vector<Stop*>& bus_route, RouteType type);
+    struct DistanceDescription {
+        std::string_view from;
+        std::string_view to;
+        int distance = 0;
+    };
 
-        std::string name;
-        std::vector<Stop*> route;
+    struct BusDescription {
+        std::string_view name;
+        std::vector<std::string_view> stops;
         RouteType type = RouteType::ROUND_TRIP;
     };
 
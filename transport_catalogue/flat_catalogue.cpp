@@ -0,0 +1,268 @@
+#include "flat_catalogue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace transport_catalogue {
+
+    namespace {
+
+        size_t Align(size_t offset) {
+            return (offset + 7) & ~size_t{7};
+        }
+
+        template <typename T>
+        void WriteSection(std::ostream& out, const std::vector<T>& section, size_t& offset) {
+            static const char padding[8] = {};
+            out.write(padding, static_cast<std::streamsize>(Align(offset) - offset));
+            offset = Align(offset);
+            out.write(reinterpret_cast<const char*>(section.data()), static_cast<std::streamsize>(section.size() * sizeof(T)));
+            offset += section.size() * sizeof(T);
+        }
+
+        // Возвращает номера объектов, отсортированные по названию
+        template <typename FlatObject>
+        std::vector<uint32_t> MakeNameIndex(const std::vector<FlatObject>& objects, const std::string& names) {
+            std::vector<uint32_t> result(objects.size());
+            std::iota(result.begin(), result.end(), 0);
+            std::sort(result.begin(), result.end(), [&objects, &names](uint32_t lhs, uint32_t rhs) {
+                return std::string_view(names).substr(objects[lhs].name_offset, objects[lhs].name_size)
+                       < std::string_view(names).substr(objects[rhs].name_offset, objects[rhs].name_size);
+            });
+            return result;
+        }
+
+    } // namespace
+
+    void WriteFlatCatalogue(const TransportCatalogue& db, std::ostream& out) {
+        const size_t stop_count = db.GetStopCount();
+        const size_t bus_count = db.GetBusCount();
+
+        std::string names;
+        auto add_name = [&names](std::string_view name) {
+            uint32_t offset = static_cast<uint32_t>(names.size());
+            names += name;
+            return offset;
+        };
+
+        //Номера остановок и автобусов в файле совпадают с номерами в каталоге
+        std::vector<flat::Bus> flat_buses;
+        flat_buses.reserve(bus_count);
+        for (BusId bus = 0; bus < bus_count; ++bus) {
+            const std::string_view name = db.GetBusName(bus);
+            const RouteInfo& route_info = db.GetRouteInfo(bus);
+            flat::Bus& flat_bus = flat_buses.emplace_back();
+            flat_bus.name_offset = add_name(name);
+            flat_bus.name_size = static_cast<uint32_t>(name.size());
+            flat_bus.total_stops = static_cast<uint32_t>(route_info.total_stops);
+            flat_bus.uniq_stops = static_cast<uint32_t>(route_info.uniq_stops);
+            flat_bus.real_length = route_info.real_length;
+            flat_bus.reserved = 0;
+            flat_bus.curvature = route_info.curvature;
+        }
+
+        std::vector<flat::Stop> flat_stops;
+        std::vector<uint32_t> stop_buses;
+        flat_stops.reserve(stop_count);
+        for (StopId stop = 0; stop < stop_count; ++stop) {
+            const std::string_view name = db.GetStopName(stop);
+            const geo::Coordinates coords = db.GetStopCoords(stop);
+            flat::Stop& flat_stop = flat_stops.emplace_back();
+            flat_stop.name_offset = add_name(name);
+            flat_stop.name_size = static_cast<uint32_t>(name.size());
+            flat_stop.lat = coords.lat;
+            flat_stop.lng = coords.lng;
+
+            //GetStopBuses уже отдаёт автобусы в нужном порядке
+            flat_stop.buses_begin = static_cast<uint32_t>(stop_buses.size());
+            for (BusId bus : db.GetStopBuses(stop)) {
+                stop_buses.push_back(bus);
+            }
+            flat_stop.buses_end = static_cast<uint32_t>(stop_buses.size());
+        }
+
+        std::vector<uint32_t> stop_index = MakeNameIndex(flat_stops, names);
+        std::vector<uint32_t> bus_index = MakeNameIndex(flat_buses, names);
+
+        flat::Header header{};
+        std::memcpy(header.magic, flat::MAGIC, sizeof(header.magic));
+        header.stop_count = static_cast<uint32_t>(flat_stops.size());
+        header.bus_count = static_cast<uint32_t>(flat_buses.size());
+        header.stop_bus_count = static_cast<uint32_t>(stop_buses.size());
+
+        //Раскладываем секции друг за другом с выравниванием
+        size_t offset = sizeof(flat::Header);
+        auto place = [&offset](size_t section_size) {
+            offset = Align(offset);
+            uint64_t result = offset;
+            offset += section_size;
+            return result;
+        };
+        header.stops_offset = place(flat_stops.size() * sizeof(flat::Stop));
+        header.buses_offset = place(flat_buses.size() * sizeof(flat::Bus));
+        header.stop_index_offset = place(stop_index.size() * sizeof(uint32_t));
+        header.bus_index_offset = place(bus_index.size() * sizeof(uint32_t));
+        header.stop_buses_offset = place(stop_buses.size() * sizeof(uint32_t));
+        header.names_offset = place(names.size());
+        header.names_size = names.size();
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        offset = sizeof(flat::Header);
+        WriteSection(out, flat_stops, offset);
+        WriteSection(out, flat_buses, offset);
+        WriteSection(out, stop_index, offset);
+        WriteSection(out, bus_index, offset);
+        WriteSection(out, stop_buses, offset);
+        WriteSection(out, std::vector<char>(names.begin(), names.end()), offset);
+    }
+
+    FlatCatalogue::FlatCatalogue(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open flat catalogue \""s + path + "\""s);
+        }
+
+        struct stat file_stat{};
+        if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(flat::Header)) {
+            close(fd);
+            throw std::runtime_error("Flat catalogue \""s + path + "\" is too small"s);
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+
+        void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Could not map flat catalogue \""s + path + "\""s);
+        }
+        data_ = static_cast<const char*>(mapped);
+
+        header_ = reinterpret_cast<const flat::Header*>(data_);
+
+        //Проверяем, что все секции целиком лежат внутри файла
+        auto section_fits = [this](uint64_t offset, uint64_t count, size_t item_size) {
+            return offset % 8 == 0 && offset <= size_ && count <= (size_ - offset) / item_size;
+        };
+        if (std::memcmp(header_->magic, flat::MAGIC, sizeof(flat::MAGIC)) != 0
+            || !section_fits(header_->stops_offset, header_->stop_count, sizeof(flat::Stop))
+            || !section_fits(header_->buses_offset, header_->bus_count, sizeof(flat::Bus))
+            || !section_fits(header_->stop_index_offset, header_->stop_count, sizeof(uint32_t))
+            || !section_fits(header_->bus_index_offset, header_->bus_count, sizeof(uint32_t))
+            || !section_fits(header_->stop_buses_offset, header_->stop_bus_count, sizeof(uint32_t))
+            || !section_fits(header_->names_offset, header_->names_size, sizeof(char))) {
+            munmap(const_cast<char*>(data_), size_);
+            throw std::runtime_error("Flat catalogue \""s + path + "\" is corrupted"s);
+        }
+
+        stops_ = reinterpret_cast<const flat::Stop*>(data_ + header_->stops_offset);
+        buses_ = reinterpret_cast<const flat::Bus*>(data_ + header_->buses_offset);
+        stop_index_ = reinterpret_cast<const uint32_t*>(data_ + header_->stop_index_offset);
+        bus_index_ = reinterpret_cast<const uint32_t*>(data_ + header_->bus_index_offset);
+        stop_buses_ = reinterpret_cast<const uint32_t*>(data_ + header_->stop_buses_offset);
+        names_ = data_ + header_->names_offset;
+
+        if (!HasValidRecords()) {
+            munmap(const_cast<char*>(data_), size_);
+            throw std::runtime_error("Flat catalogue \""s + path + "\" is corrupted"s);
+        }
+    }
+
+    FlatCatalogue::~FlatCatalogue() {
+        munmap(const_cast<char*>(data_), size_);
+    }
+
+    bool FlatCatalogue::IsBusExists(std::string_view bus_name) const noexcept {
+        return FindBus(bus_name) != nullptr;
+    }
+
+    bool FlatCatalogue::IsStopExists(std::string_view stop_name) const noexcept {
+        return FindStop(stop_name) != nullptr;
+    }
+
+    RouteInfo FlatCatalogue::GetRouteInfo(std::string_view bus_name) const {
+        const uint32_t* bus_id = FindBus(bus_name);
+        if (bus_id == nullptr) {
+            return {};
+        }
+        const flat::Bus& bus = buses_[*bus_id];
+        return {bus.total_stops, bus.uniq_stops, bus.real_length, bus.curvature};
+    }
+
+    ranges::Range<FlatCatalogue::BusNameIterator> FlatCatalogue::GetStopBuses(std::string_view stop_name) const {
+        const uint32_t* stop_id = FindStop(stop_name);
+        if (stop_id == nullptr) {
+            return {{*this, stop_buses_}, {*this, stop_buses_}};
+        }
+        const flat::Stop& stop = stops_[*stop_id];
+        return {{*this, stop_buses_ + stop.buses_begin}, {*this, stop_buses_ + stop.buses_end}};
+    }
+
+    std::optional<FlatCatalogue::StopView> FlatCatalogue::GetStop(std::string_view stop_name) const {
+        const uint32_t* stop_id = FindStop(stop_name);
+        if (stop_id == nullptr) {
+            return std::nullopt;
+        }
+        const flat::Stop& stop = stops_[*stop_id];
+        return StopView{GetStopName(*stop_id), {stop.lat, stop.lng}};
+    }
+
+    bool FlatCatalogue::HasValidRecords() const {
+        auto name_fits = [this](uint32_t name_offset, uint32_t name_size) {
+            return name_offset <= header_->names_size && name_size <= header_->names_size - name_offset;
+        };
+        auto ids_below = [](const uint32_t* begin, const uint32_t* end, uint32_t count) {
+            return std::all_of(begin, end, [count](uint32_t id) {
+                return id < count;
+            });
+        };
+
+        for (const flat::Stop& stop : ranges::Range{stops_, stops_ + header_->stop_count}) {
+            if (!name_fits(stop.name_offset, stop.name_size)
+                || stop.buses_begin > stop.buses_end || stop.buses_end > header_->stop_bus_count) {
+                return false;
+            }
+        }
+        for (const flat::Bus& bus : ranges::Range{buses_, buses_ + header_->bus_count}) {
+            if (!name_fits(bus.name_offset, bus.name_size)) {
+                return false;
+            }
+        }
+        return ids_below(stop_index_, stop_index_ + header_->stop_count, header_->stop_count)
+               && ids_below(bus_index_, bus_index_ + header_->bus_count, header_->bus_count)
+               && ids_below(stop_buses_, stop_buses_ + header_->stop_bus_count, header_->bus_count);
+    }
+
+    std::string_view FlatCatalogue::GetStopName(uint32_t stop_id) const {
+        return {names_ + stops_[stop_id].name_offset, stops_[stop_id].name_size};
+    }
+
+    std::string_view FlatCatalogue::GetBusName(uint32_t bus_id) const {
+        return {names_ + buses_[bus_id].name_offset, buses_[bus_id].name_size};
+    }
+
+    const uint32_t* FlatCatalogue::FindStop(std::string_view stop_name) const {
+        const uint32_t* end = stop_index_ + header_->stop_count;
+        const uint32_t* it = std::lower_bound(stop_index_, end, stop_name, [this](uint32_t stop_id, std::string_view name) {
+            return GetStopName(stop_id) < name;
+        });
+        return it != end && GetStopName(*it) == stop_name ? it : nullptr;
+    }
+
+    const uint32_t* FlatCatalogue::FindBus(std::string_view bus_name) const {
+        const uint32_t* end = bus_index_ + header_->bus_count;
+        const uint32_t* it = std::lower_bound(bus_index_, end, bus_name, [this](uint32_t bus_id, std::string_view name) {
+            return GetBusName(bus_id) < name;
+        });
+        return it != end && GetBusName(*it) == bus_name ? it : nullptr;
+    }
+
+} //namespace transport_catalogue
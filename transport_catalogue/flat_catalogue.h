@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "geo/geo.h"
+#include "domain.h"
+#include "router/ranges.h"
+#include "transport_catalogue.h"
+
+namespace transport_catalogue {
+
+    /*
+     * Плоский бинарный формат каталога. Файл отображается в память целиком
+     * и читается на месте, без разбора и копирования.
+     * Все секции выровнены по 8 байт, порядок байт - родной для машины, на которой собрана база.
+     *
+     * [Header][Stop x stop_count][Bus x bus_count][stop_index][bus_index][stop buses][names]
+     *
+     * Статистика маршрута считается при записи и хранится в записи автобуса,
+     * поэтому сами маршруты и расстояния в файл не попадают
+     */
+    namespace flat {
+
+        inline constexpr char MAGIC[8] = {'T', 'C', 'F', 'L', 'A', 'T', '0', '2'};
+
+        struct Header {
+            char magic[8];
+            uint32_t stop_count;
+            uint32_t bus_count;
+            uint32_t stop_bus_count;
+            uint32_t reserved;
+            uint64_t stops_offset;
+            uint64_t buses_offset;
+            uint64_t stop_index_offset; // номера остановок, отсортированные по названию
+            uint64_t bus_index_offset; // номера автобусов, отсортированные по названию
+            uint64_t stop_buses_offset;
+            uint64_t names_offset;
+            uint64_t names_size;
+        };
+
+        struct Stop {
+            uint32_t name_offset;
+            uint32_t name_size;
+            double lat;
+            double lng;
+            // Полуинтервал в секции stop buses
+            uint32_t buses_begin;
+            uint32_t buses_end;
+        };
+
+        struct Bus {
+            uint32_t name_offset;
+            uint32_t name_size;
+            // Готовый RouteInfo маршрута
+            uint32_t total_stops;
+            uint32_t uniq_stops;
+            int32_t real_length;
+            uint32_t reserved;
+            double curvature;
+        };
+
+    } // namespace flat
+
+    // Записывает каталог в поток out в плоском формате
+    void WriteFlatCatalogue(const TransportCatalogue& db, std::ostream& out);
+
+    /*
+     * Каталог только для чтения поверх отображённого в память файла плоского формата.
+     * Повторяет поисковый интерфейс TransportCatalogue
+     */
+    class FlatCatalogue {
+    public:
+        struct StopView {
+            std::string_view name;
+            geo::Coordinates coords;
+        };
+
+        // Итератор по названиям автобусов остановки
+        class BusNameIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = std::string_view;
+
+            BusNameIterator(const FlatCatalogue& db, const uint32_t* bus_id) : db_(&db), bus_id_(bus_id) {}
+
+            std::string_view operator*() const {
+                return db_->GetBusName(*bus_id_);
+            }
+
+            BusNameIterator& operator++() {
+                ++bus_id_;
+                return *this;
+            }
+
+            bool operator==(const BusNameIterator& other) const {
+                return bus_id_ == other.bus_id_;
+            }
+
+            bool operator!=(const BusNameIterator& other) const {
+                return !(*this == other);
+            }
+
+        private:
+            const FlatCatalogue* db_;
+            const uint32_t* bus_id_;
+        };
+
+        /*
+         * Отображает файл path в память. Бросает std::runtime_error, если файл не удалось открыть или он повреждён:
+         * секции, номера и названия всех записей проверяются сразу, чтобы запросы не читали за пределами файла
+         */
+        explicit FlatCatalogue(const std::string& path);
+        ~FlatCatalogue();
+
+        bool IsBusExists(std::string_view bus_name) const noexcept;
+        bool IsStopExists(std::string_view stop_name) const noexcept;
+
+        RouteInfo GetRouteInfo(std::string_view bus_name) const;
+        ranges::Range<BusNameIterator> GetStopBuses(std::string_view stop_name) const;
+        std::optional<StopView> GetStop(std::string_view stop_name) const;
+
+        FlatCatalogue(const FlatCatalogue&) = delete;
+        FlatCatalogue& operator=(const FlatCatalogue&) = delete;
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+
+        const flat::Header* header_ = nullptr;
+        const flat::Stop* stops_ = nullptr;
+        const flat::Bus* buses_ = nullptr;
+        const uint32_t* stop_index_ = nullptr;
+        const uint32_t* bus_index_ = nullptr;
+        const uint32_t* stop_buses_ = nullptr;
+        const char* names_ = nullptr;
+
+        // Все номера и полуинтервалы записей указывают внутрь своих секций
+        bool HasValidRecords() const;
+
+        std::string_view GetStopName(uint32_t stop_id) const;
+        std::string_view GetBusName(uint32_t bus_id) const;
+
+        // Возвращают номер по названию или nullptr, если такого нет
+        const uint32_t* FindStop(std::string_view stop_name) const;
+        const uint32_t* FindBus(std::string_view bus_name) const;
+    };
+
+} //namespace transport_catalogue
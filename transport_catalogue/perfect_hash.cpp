@@ -0,0 +1,160 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std::literals;
+
+namespace transport_catalogue {
+
+    namespace {
+
+        constexpr uint64_t GOLDEN = 0x9e3779b97f4a7c15ull;
+        // Среднее число ключей в корзине
+        constexpr size_t KEYS_PER_BUCKET = 4;
+        // Сколько смещений перебирается для корзины, прежде чем сменить seed
+        constexpr uint32_t MAX_DISPLACEMENT = 1u << 24;
+        constexpr int MAX_ATTEMPTS = 32;
+
+        //Финальное перемешивание из MurmurHash3
+        uint64_t Mix(uint64_t key) {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdull;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ull;
+            key ^= key >> 33;
+            return key;
+        }
+
+        uint64_t HashString(std::string_view str, uint64_t seed) {
+            uint64_t hash = seed ^ (str.size() * GOLDEN);
+            size_t pos = 0;
+            for (; pos + sizeof(uint64_t) <= str.size(); pos += sizeof(uint64_t)) {
+                uint64_t chunk;
+                std::memcpy(&chunk, str.data() + pos, sizeof(chunk));
+                hash = (hash ^ chunk) * 0xbf58476d1ce4e5b9ull;
+                hash ^= hash >> 31;
+            }
+            if (pos < str.size()) {
+                //Хвост длинной строки читаем последними восемью байтами, чтобы не копировать переменную длину
+                uint64_t chunk = 0;
+                if (str.size() >= sizeof(uint64_t)) {
+                    std::memcpy(&chunk, str.data() + str.size() - sizeof(uint64_t), sizeof(chunk));
+                } else {
+                    for (size_t i = pos; i < str.size(); ++i) {
+                        chunk = (chunk << 8) | static_cast<unsigned char>(str[i]);
+                    }
+                }
+                hash = (hash ^ chunk) * 0xbf58476d1ce4e5b9ull;
+                hash ^= hash >> 31;
+            }
+            return Mix(hash);
+        }
+
+    } // namespace
+
+    void PerfectHash::Build(const std::vector<std::string_view>& keys, const std::vector<uint32_t>& values) {
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+            seed_ = GOLDEN * (attempt + 1);
+            if (TryBuild(keys, values)) {
+                return;
+            }
+        }
+        //С различными ключами сюда практически невозможно попасть
+        throw std::logic_error("failed to build perfect hash, keys may be duplicated"s);
+    }
+
+    std::optional<uint32_t> PerfectHash::Find(std::string_view key) const {
+        if (slots_.empty()) {
+            return std::nullopt;
+        }
+        const uint64_t hash = HashString(key, seed_);
+        const Slot& slot = slots_[GetSlot(hash, displacements_[GetBucket(hash)])];
+        if (slot.key != key) {
+            return std::nullopt;
+        }
+        return slot.value;
+    }
+
+    //Отображение в [0, n) умножением вместо деления
+    uint32_t PerfectHash::GetBucket(uint64_t hash) const {
+        return static_cast<uint32_t>(((hash & 0xffffffffull) * displacements_.size()) >> 32);
+    }
+
+    uint32_t PerfectHash::GetSlot(uint64_t hash, uint32_t displacement) const {
+        return static_cast<uint32_t>(((Mix(hash + displacement * GOLDEN) >> 32) * slots_.size()) >> 32);
+    }
+
+    bool PerfectHash::TryBuild(const std::vector<std::string_view>& keys, const std::vector<uint32_t>& values) {
+        const size_t key_count = keys.size();
+        slots_.assign(key_count, Slot{});
+        displacements_.assign(std::max<size_t>(1, (key_count + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET), 0);
+        if (key_count == 0) {
+            slots_.clear();
+            return true;
+        }
+
+        //Раскладываем ключи по корзинам подсчётом
+        std::vector<uint64_t> hashes(key_count);
+        std::vector<uint32_t> bucket_offsets(displacements_.size() + 1, 0);
+        for (size_t i = 0; i < key_count; ++i) {
+            hashes[i] = HashString(keys[i], seed_);
+            ++bucket_offsets[GetBucket(hashes[i]) + 1];
+        }
+        for (size_t i = 1; i < bucket_offsets.size(); ++i) {
+            bucket_offsets[i] += bucket_offsets[i - 1];
+        }
+        std::vector<uint32_t> bucket_keys(key_count);
+        std::vector<uint32_t> positions(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (uint32_t i = 0; i < key_count; ++i) {
+            bucket_keys[positions[GetBucket(hashes[i])]++] = i;
+        }
+
+        //Большие корзины размещаем первыми, пока таблица пустая
+        std::vector<uint32_t> bucket_order(displacements_.size());
+        for (uint32_t i = 0; i < bucket_order.size(); ++i) {
+            bucket_order[i] = i;
+        }
+        std::stable_sort(bucket_order.begin(), bucket_order.end(), [&bucket_offsets](uint32_t lhs, uint32_t rhs) {
+            return bucket_offsets[lhs + 1] - bucket_offsets[lhs] > bucket_offsets[rhs + 1] - bucket_offsets[rhs];
+        });
+
+        std::vector<bool> taken(key_count, false);
+        std::vector<uint32_t> bucket_slots;
+        for (uint32_t bucket : bucket_order) {
+            const uint32_t* begin = bucket_keys.data() + bucket_offsets[bucket];
+            const uint32_t* end = bucket_keys.data() + bucket_offsets[bucket + 1];
+            if (begin == end) {
+                break;
+            }
+
+            bool placed = false;
+            for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT && !placed; ++displacement) {
+                bucket_slots.clear();
+                for (const uint32_t* key = begin; key != end; ++key) {
+                    const uint32_t slot = GetSlot(hashes[*key], displacement);
+                    if (taken[slot] || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                        break;
+                    }
+                    bucket_slots.push_back(slot);
+                }
+                if (bucket_slots.size() != static_cast<size_t>(end - begin)) {
+                    continue;
+                }
+
+                for (size_t i = 0; i < bucket_slots.size(); ++i) {
+                    taken[bucket_slots[i]] = true;
+                    slots_[bucket_slots[i]] = {keys[begin[i]], values[begin[i]]};
+                }
+                displacements_[bucket] = displacement;
+                placed = true;
+            }
+            if (!placed) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} //namespace transport_catalogue
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+    /*
+     * Минимальная совершенная хэш-функция по неизменному набору строк (схема CHD, "hash and displace").
+     * Ключи раскладываются по корзинам, для каждой корзины подбирается смещение, при котором
+     * все её ключи попадают в свободные ячейки. Ячеек ровно столько же, сколько ключей.
+     * Поиск - хэш строки, одно чтение смещения, перемешивание и одно сравнение строки в ячейке, без делений
+     */
+    class PerfectHash {
+    public:
+        PerfectHash() = default;
+
+        // Строит функцию, отображающую keys[i] в values[i]. Ключи должны быть различны и жить дольше объекта
+        void Build(const std::vector<std::string_view>& keys, const std::vector<uint32_t>& values);
+
+        // Номер ключа или nullopt, если такого ключа не было
+        std::optional<uint32_t> Find(std::string_view key) const;
+
+    private:
+        struct Slot {
+            std::string_view key;
+            uint32_t value = 0;
+        };
+
+        uint64_t seed_ = 0;
+        std::vector<uint32_t> displacements_;
+        std::vector<Slot> slots_;
+
+        uint32_t GetBucket(uint64_t hash) const;
+        uint32_t GetSlot(uint64_t hash, uint32_t displacement) const;
+        // Пытается разложить ключи с текущим seed_. Возвращает false, если какую-то корзину разместить не удалось
+        bool TryBuild(const std::vector<std::string_view>& keys, const std::vector<uint32_t>& values);
+    };
+
+} //namespace transport_catalogue
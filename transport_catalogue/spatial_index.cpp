@@ -0,0 +1,157 @@
+#include "spatial_index.h"
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+namespace transport_catalogue {
+
+    namespace {
+
+        // Раскладывает items[begin, end) в неявное k-d дерево: медиана по оси axis встаёт в середину отрезка
+        template <typename Item, typename GetCoord>
+        void BuildTree(std::vector<Item>& items, size_t begin, size_t end, int axis, int dimensions,
+                       GetCoord get_coord) {
+            if (end - begin < 2) {
+                return;
+            }
+            const size_t mid = begin + (end - begin) / 2;
+            std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                             [axis, &get_coord](const Item& lhs, const Item& rhs) {
+                                 return get_coord(lhs, axis) < get_coord(rhs, axis);
+                             });
+            const int next_axis = (axis + 1) % dimensions;
+            BuildTree(items, begin, mid, next_axis, dimensions, get_coord);
+            BuildTree(items, mid + 1, end, next_axis, dimensions, get_coord);
+        }
+
+        double GetAreaCoord(geo::Coordinates point, int axis) {
+            return axis == 0 ? point.lat : point.lng;
+        }
+
+    } // namespace
+
+    void SpatialIndex::Build(const std::vector<uint32_t>& ids, const std::vector<double>& latitudes,
+                             const std::vector<double>& longitudes) {
+        std::vector<std::pair<geo::Coordinates, uint32_t>> area_items;
+        std::vector<std::pair<Point3, uint32_t>> sphere_items;
+        area_items.reserve(ids.size());
+        sphere_items.reserve(ids.size());
+        for (uint32_t id : ids) {
+            const geo::Coordinates point{latitudes[id], longitudes[id]};
+            area_items.push_back({point, id});
+            sphere_items.push_back({ToSphere(point), id});
+        }
+
+        BuildTree(area_items, 0, area_items.size(), 0, 2, [](const auto& item, int axis) {
+            return GetAreaCoord(item.first, axis);
+        });
+        BuildTree(sphere_items, 0, sphere_items.size(), 0, 3, [](const auto& item, int axis) {
+            return item.first[axis];
+        });
+
+        area_ids_.resize(ids.size());
+        area_points_.resize(ids.size());
+        sphere_ids_.resize(ids.size());
+        sphere_points_.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            area_points_[i] = area_items[i].first;
+            area_ids_[i] = area_items[i].second;
+            sphere_points_[i] = sphere_items[i].first;
+            sphere_ids_[i] = sphere_items[i].second;
+        }
+    }
+
+    std::vector<uint32_t> SpatialIndex::FindNearest(geo::Coordinates point, size_t count) const {
+        if (count == 0 || sphere_ids_.empty()) {
+            return {};
+        }
+        const Point3 target = ToSphere(point);
+
+        //Куча держит лучших найденных по квадрату хорды, сверху худший из них.
+        //При равных расстояниях меньший номер считается ближе, так ответ не зависит от обхода
+        using Candidate = std::pair<double, uint32_t>;
+        std::priority_queue<Candidate> best;
+
+        auto visit = [&](auto& self, size_t begin, size_t end, int axis) -> void {
+            if (begin >= end) {
+                return;
+            }
+            const size_t mid = begin + (end - begin) / 2;
+            const Point3& node = sphere_points_[mid];
+            double distance = 0.0;
+            for (int i = 0; i < 3; ++i) {
+                distance += (node[i] - target[i]) * (node[i] - target[i]);
+            }
+            const Candidate candidate{distance, sphere_ids_[mid]};
+            if (best.size() < count) {
+                best.push(candidate);
+            } else if (candidate < best.top()) {
+                best.pop();
+                best.push(candidate);
+            }
+
+            const double delta = target[axis] - node[axis];
+            const int next_axis = (axis + 1) % 3;
+            //Сначала спускаемся в половину, где лежит точка, дальнюю смотрим, только если она может быть ближе худшего
+            const bool is_left_near = delta < 0.0;
+            self(self, is_left_near ? begin : mid + 1, is_left_near ? mid : end, next_axis);
+            if (best.size() < count || delta * delta <= best.top().first) {
+                self(self, is_left_near ? mid + 1 : begin, is_left_near ? end : mid, next_axis);
+            }
+        };
+        visit(visit, 0, sphere_ids_.size(), 0);
+
+        std::vector<uint32_t> result(best.size());
+        for (auto it = result.rbegin(); it != result.rend(); ++it) {
+            *it = best.top().second;
+            best.pop();
+        }
+        return result;
+    }
+
+    std::vector<uint32_t> SpatialIndex::FindInArea(geo::Coordinates min, geo::Coordinates max) const {
+        std::vector<uint32_t> result;
+        if (min.lat > max.lat) {
+            return result;
+        }
+        if (min.lng <= max.lng) {
+            FindInArea(0, area_ids_.size(), 0, min, max, result);
+        } else {
+            FindInArea(0, area_ids_.size(), 0, min, {max.lat, 180.0}, result);
+            FindInArea(0, area_ids_.size(), 0, {min.lat, -180.0}, max, result);
+        }
+        return result;
+    }
+
+    SpatialIndex::Point3 SpatialIndex::ToSphere(geo::Coordinates point) {
+        const double dr = M_PI / 180.;
+        const double lat = point.lat * dr;
+        const double lng = point.lng * dr;
+        return {std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat)};
+    }
+
+    void SpatialIndex::FindInArea(size_t begin, size_t end, int axis, geo::Coordinates min, geo::Coordinates max,
+                                  std::vector<uint32_t>& result) const {
+        if (begin >= end) {
+            return;
+        }
+        const size_t mid = begin + (end - begin) / 2;
+        const geo::Coordinates node = area_points_[mid];
+        if (node.lat >= min.lat && node.lat <= max.lat && node.lng >= min.lng && node.lng <= max.lng) {
+            result.push_back(area_ids_[mid]);
+        }
+
+        const double value = GetAreaCoord(node, axis);
+        const int next_axis = (axis + 1) % 2;
+        if (GetAreaCoord(min, axis) <= value) {
+            FindInArea(begin, mid, next_axis, min, max, result);
+        }
+        if (GetAreaCoord(max, axis) >= value) {
+            FindInArea(mid + 1, end, next_axis, min, max, result);
+        }
+    }
+
+} //namespace transport_catalogue
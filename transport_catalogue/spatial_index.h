@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geo/geo.h"
+
+namespace transport_catalogue {
+
+    /*
+     * Пространственный индекс остановок - два неявных k-d дерева, хранящихся в массивах.
+     * Прямоугольники ищутся по дереву над широтой и долготой.
+     * Ближайшие - по дереву над точками единичной сферы: длина хорды растёт вместе с расстоянием
+     * по дуге, поэтому порядок остановок тот же, что у geo::ComputeDistance, а отсечение по
+     * прямоугольной ячейке в пространстве остаётся точным
+     */
+    class SpatialIndex {
+    public:
+        SpatialIndex() = default;
+
+        // Строит индекс по точкам ids[i] с координатами (latitudes[ids[i]], longitudes[ids[i]])
+        void Build(const std::vector<uint32_t>& ids, const std::vector<double>& latitudes,
+                   const std::vector<double>& longitudes);
+
+        // Не более count ближайших к point точек по возрастанию расстояния
+        std::vector<uint32_t> FindNearest(geo::Coordinates point, size_t count) const;
+
+        // Точки внутри прямоугольника [min, max], границы включаются. Если min.lng > max.lng,
+        // прямоугольник пересекает 180-й меридиан
+        std::vector<uint32_t> FindInArea(geo::Coordinates min, geo::Coordinates max) const;
+
+    private:
+        using Point3 = std::array<double, 3>;
+
+        // Узел дерева - середина своего отрезка массива, ось разбиения чередуется с глубиной
+        std::vector<uint32_t> area_ids_;
+        std::vector<geo::Coordinates> area_points_;
+        std::vector<uint32_t> sphere_ids_;
+        std::vector<Point3> sphere_points_;
+
+        static Point3 ToSphere(geo::Coordinates point);
+
+        void FindInArea(size_t begin, size_t end, int axis, geo::Coordinates min, geo::Coordinates max,
+                        std::vector<uint32_t>& result) const;
+    };
+
+} //namespace transport_catalogue
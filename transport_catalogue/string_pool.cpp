@@ -0,0 +1,33 @@
+#include "string_pool.h"
+
+#include <cstring>
+#include <utility>
+
+namespace transport_catalogue {
+
+    std::string_view StringPool::Add(std::string_view str) {
+        if (str.empty()) {
+            return {};
+        }
+
+        //Длинная строка получает собственный блок, чтобы не бросать недозаполненным текущий
+        if (str.size() > BLOCK_SIZE / 4) {
+            std::unique_ptr<char[]> block(new char[str.size()]);
+            std::memcpy(block.get(), str.data(), str.size());
+            const char* data = block.get();
+            blocks_.insert(blocks_.empty() ? blocks_.end() : blocks_.end() - 1, std::move(block));
+            return {data, str.size()};
+        }
+
+        if (block_used_ + str.size() > BLOCK_SIZE) {
+            blocks_.emplace_back(new char[BLOCK_SIZE]);
+            block_used_ = 0;
+        }
+
+        char* dest = blocks_.back().get() + block_used_;
+        std::memcpy(dest, str.data(), str.size());
+        block_used_ += str.size();
+        return {dest, str.size()};
+    }
+
+} //namespace transport_catalogue
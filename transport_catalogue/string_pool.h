@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+    /*
+     * Хранилище строк каталога. Строки складываются подряд в крупные блоки,
+     * блоки не перевыделяются, поэтому выданные string_view живут столько же, сколько само хранилище
+     */
+    class StringPool {
+    public:
+        StringPool() = default;
+
+        // Копирует строку в хранилище и возвращает view на копию
+        std::string_view Add(std::string_view str);
+
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+    private:
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        size_t block_used_ = BLOCK_SIZE; // занятое место в последнем блоке
+    };
+
+} //namespace transport_catalogue
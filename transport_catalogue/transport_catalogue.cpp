@@ -1,147 +1,414 @@
 #include "transport_catalogue.h"
 
-#include <unordered_set>
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+using namespace std::literals;
 
 namespace transport_catalogue {
 
-    namespace detail {
+    namespace {
+
+        // Меньше стольких элементов на поток параллелить невыгодно
+        constexpr size_t MIN_PARALLEL_CHUNK = 256;
 
-        size_t StopsHasher::operator()(const std::pair<const Stop*, const Stop*> &stops) const {
-            return ptr_hasher_(stops.first) + ptr_hasher_(stops.second) * 37;
+        // Делит [0, count) на отрезки по числу ядер и вызывает func(begin, end) для каждого.
+        // Исключение из любого отрезка пробрасывается вызывающему
+        template <typename Func>
+        void ForEachChunk(size_t count, Func func) {
+            const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+            const size_t threads = std::min(max_threads, (count + MIN_PARALLEL_CHUNK - 1) / MIN_PARALLEL_CHUNK);
+            if (threads <= 1) {
+                func(size_t{0}, count);
+                return;
+            }
+
+            const size_t chunk = (count + threads - 1) / threads;
+            std::vector<std::future<void>> tasks;
+            tasks.reserve(threads - 1);
+            for (size_t begin = chunk; begin < count; begin += chunk) {
+                tasks.push_back(std::async(std::launch::async, func, begin, std::min(count, begin + chunk)));
+            }
+            func(size_t{0}, chunk);
+            for (std::future<void>& task : tasks) {
+                task.get();
+            }
         }
 
-    } //namespace detail
+    } // namespace
+
+    StopId TransportCatalogue::AddStop(std::string_view name, double latitude, double longitude) {
+        const StopId id = static_cast<StopId>(stop_names_.size());
+
+        const std::string_view stop_name = stop_names_.emplace_back(InternName(name));
+        stop_latitudes_.push_back(latitude);
+        stop_longitudes_.push_back(longitude);
+        stop_spherical_.push_back(geo::ToSpherical({latitude, longitude}));
+        is_finalized_ = false;
 
-    void TransportCatalogue::AddStop(std::string_view name, double latitude, double longitude) {
-        Stop* new_stop_ptr = &stops_source_.emplace_back(
-                name,
-                latitude, longitude
-        );
-        name_to_stop_[new_stop_ptr->name] = new_stop_ptr;
+        name_to_stop_[stop_name] = id;
+        return id;
     }
 
-    void TransportCatalogue::AddBus(std::string_view name, const std::vector<std::string_view>& raw_route, RouteType type) {
-        std::vector<Stop*> route;
-        route.reserve(raw_route.size());
+    BusId TransportCatalogue::AddBus(std::string_view name, const std::vector<std::string_view>& raw_route, RouteType type) {
+        const BusId id = static_cast<BusId>(bus_names_.size());
 
+        std::vector<StopId> route;
+        route.reserve(raw_route.size());
         for (std::string_view stop : raw_route) {
             route.push_back(name_to_stop_.at(stop));
         }
+        route_stops_.insert(route_stops_.end(), route.begin(), route.end());
+        route_offsets_.push_back(route_stops_.size());
 
-        Bus* new_bus_ptr = &buses_source_.emplace_back(
-                name,
-                route,
-                type
-        );
-        name_to_bus_[new_bus_ptr->name] = new_bus_ptr;
+        const std::string_view bus_name = bus_names_.emplace_back(InternName(name));
+        bus_types_.push_back(type);
+        name_to_bus_[bus_name] = id;
 
-        //Добавляем автобус ко всем остановкам, через которые он проходит
+        route_real_forward_.resize(route_stops_.size());
+        route_real_backward_.resize(route_stops_.size());
+        route_geo_.resize(route_stops_.size());
+        route_infos_.emplace_back();
+        UpdateRouteStats(id);
+        is_finalized_ = false;
 
-        for (Stop* stop : new_bus_ptr->route) {
-            stop_to_buses_[stop].insert(new_bus_ptr->name);
+        return id;
+    }
+
+    void TransportCatalogue::AddBulk(const std::vector<StopDescription>& stops,
+                                     const std::vector<DistanceDescription>& distances,
+                                     const std::vector<BusDescription>& buses) {
+        //Все столбцы и словари растут один раз
+        const size_t stop_count = stop_names_.size() + stops.size();
+        stop_names_.reserve(stop_count);
+        stop_latitudes_.reserve(stop_count);
+        stop_longitudes_.reserve(stop_count);
+        stop_spherical_.reserve(stop_count);
+        name_to_stop_.reserve(name_to_stop_.size() + stops.size());
+        for (const StopDescription& stop : stops) {
+            AddStop(stop.name, stop.coords.lat, stop.coords.lng);
         }
+
+        //Обратные расстояния тоже попадают в таблицу, поэтому записей может быть вдвое больше
+        stops_to_length_.reserve(stops_to_length_.size() + distances.size() * 2);
+        for (const DistanceDescription& distance : distances) {
+            const StopId from = name_to_stop_.at(distance.from);
+            const StopId to = name_to_stop_.at(distance.to);
+            stops_to_length_.Set(from, to, distance.distance);
+            stops_to_length_.Insert(to, from, distance.distance);
+            MarkStopDirty(from);
+            MarkStopDirty(to);
+        }
+
+        //Названия остановок маршрутов разбираются параллельно: словарь остановок дальше только читается
+        std::vector<size_t> route_offsets(buses.size() + 1, 0);
+        for (size_t i = 0; i < buses.size(); ++i) {
+            route_offsets[i + 1] = route_offsets[i] + buses[i].stops.size();
+        }
+        std::vector<StopId> routes(route_offsets.back());
+        ForEachChunk(buses.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                StopId* dest = routes.data() + route_offsets[i];
+                for (std::string_view stop : buses[i].stops) {
+                    *dest++ = name_to_stop_.at(stop);
+                }
+            }
+        });
+
+        const BusId first_bus = static_cast<BusId>(bus_names_.size());
+        const size_t first_route_stop = route_stops_.size();
+        const size_t bus_count = bus_names_.size() + buses.size();
+        bus_names_.reserve(bus_count);
+        bus_types_.reserve(bus_count);
+        route_offsets_.reserve(bus_count + 1);
+        name_to_bus_.reserve(name_to_bus_.size() + buses.size());
+        route_stops_.insert(route_stops_.end(), routes.begin(), routes.end());
+        for (size_t i = 0; i < buses.size(); ++i) {
+            const std::string_view bus_name = bus_names_.emplace_back(InternName(buses[i].name));
+            bus_types_.push_back(buses[i].type);
+            route_offsets_.push_back(first_route_stop + route_offsets[i + 1]);
+            name_to_bus_[bus_name] = first_bus + static_cast<BusId>(i);
+        }
+
+        //Статистика каждого маршрута пишется в свои отрезки столбцов, потоки не пересекаются
+        route_real_forward_.resize(route_stops_.size());
+        route_real_backward_.resize(route_stops_.size());
+        route_geo_.resize(route_stops_.size());
+        route_infos_.resize(bus_names_.size());
+        ForEachChunk(buses.size(), [this, first_bus](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                UpdateRouteStats(first_bus + static_cast<BusId>(i));
+            }
+        });
+        is_finalized_ = false;
     }
 
-    RouteInfo TransportCatalogue::GetRouteInfo(std::string_view bus_name) const {
-        if (!IsBusExists(bus_name)) {
-            return {};
+    std::string_view TransportCatalogue::InternName(std::string_view name) {
+        //Каждое название и так ключ одного из словарей, так что отдельный индекс для поиска копий не нужен
+        if (auto it = name_to_stop_.find(name); it != name_to_stop_.end()) {
+            return it->first;
         }
-        const Bus& bus = *name_to_bus_.at(bus_name);
+        if (auto it = name_to_bus_.find(name); it != name_to_bus_.end()) {
+            return it->first;
+        }
+        return names_.Add(name);
+    }
 
-        size_t total_stops = bus.route.size();
-        if (bus.type == RouteType::ONE_WAY) {
-            total_stops = (total_stops * 2) - 1;
+    RouteInfo TransportCatalogue::GetRouteInfo(std::string_view bus_name) const {
+        std::optional<BusId> bus = FindBus(bus_name);
+        if (!bus) {
+            return {};
         }
+        return route_infos_[*bus];
+    }
 
-        size_t uniq_stops = std::unordered_set<Stop*>{bus.route.begin(), bus.route.end()}.size();
-        double geo_length = GetRouteGeoDistance(bus);
-        int real_length = GetRouteRealDistance(bus);
+    const RouteInfo& TransportCatalogue::GetRouteInfo(BusId bus) const {
+        return route_infos_[bus];
+    }
 
-        double curvature = real_length / geo_length;
+    int TransportCatalogue::GetRouteRealLength(BusId bus, size_t from, size_t to) const {
+        const size_t offset = route_offsets_[bus];
+        if (from <= to) {
+            return route_real_forward_[offset + to] - route_real_forward_[offset + from];
+        }
+        return route_real_backward_[offset + from] - route_real_backward_[offset + to];
+    }
 
-        return {
-                total_stops,
-                uniq_stops,
-                real_length,
-                curvature
-        };
+    BusRange TransportCatalogue::GetStopBuses(StopId stop) const {
+        if (!is_finalized_) {
+            throw std::logic_error("catalogue is not finalized"s);
+        }
+        return {stop_buses_.begin() + stop_bus_offsets_[stop], stop_buses_.begin() + stop_bus_offsets_[stop + 1]};
     }
 
-    const std::set<std::string_view>& TransportCatalogue::GetStopBuses(std::string_view stop_name) const {
-        Stop* stop = name_to_stop_.at(stop_name);
-        if (stop_to_buses_.count(stop) == 0) {
-            static const std::set<std::string_view> empty_result;
-            return empty_result;
+    std::vector<StopId> TransportCatalogue::FindNearestStops(geo::Coordinates point, size_t count) const {
+        if (!is_finalized_) {
+            throw std::logic_error("catalogue is not finalized"s);
         }
-        return stop_to_buses_.at(stop);
+        return stop_index_.FindNearest(point, count);
     }
 
-    int TransportCatalogue::GetRealLength(const Stop* first_stop, const Stop* second_stop) const {
-        std::pair<const Stop*, const Stop*> first_to_second = {first_stop, second_stop};
-        if (stops_to_length_.count(first_to_second) > 0) {
-            return stops_to_length_.at(first_to_second);
+    std::vector<StopId> TransportCatalogue::FindStopsInArea(geo::Coordinates min, geo::Coordinates max) const {
+        if (!is_finalized_) {
+            throw std::logic_error("catalogue is not finalized"s);
         }
-        return 0;
+        return stop_index_.FindInArea(min, max);
     }
 
-    double TransportCatalogue::GetRouteGeoDistance(const Bus& bus) const {
-        double distance = 0;
+    void TransportCatalogue::Finalize() {
+        //С прошлого вызова каталог не менялся
+        if (is_finalized_) {
+            return;
+        }
 
-        for (size_t i = 1; i < bus.route.size(); ++i) {
-            distance += geo::ComputeDistance(bus.route.at(i - 1)->coords, bus.route.at(i)->coords);
+        //Маршруты, загруженные раньше своих расстояний, пересчитываем один раз за все расстояния
+        if (!dirty_stops_.empty()) {
+            for (BusId bus = 0; bus < bus_names_.size(); ++bus) {
+                const RouteRange route = GetBusRoute(bus);
+                if (std::any_of(route.begin(), route.end(), [this](StopId stop) {
+                    return stop < dirty_stops_.size() && dirty_stops_[stop];
+                })) {
+                    UpdateRouteStats(bus);
+                }
+            }
+            dirty_stops_.clear();
         }
 
-        if (bus.type == RouteType::ONE_WAY) {
-            distance *= 2;
+        //Обходим автобусы по названию, тогда списки остановок сразу получаются отсортированными
+        std::vector<BusId> sorted_buses(bus_names_.size());
+        std::iota(sorted_buses.begin(), sorted_buses.end(), 0);
+        std::sort(sorted_buses.begin(), sorted_buses.end(), [this](BusId lhs, BusId rhs) {
+            return bus_names_[lhs] < bus_names_[rhs];
+        });
+
+        //Автобус может заезжать на остановку несколько раз, а в списке он должен быть один
+        constexpr BusId NO_BUS = ~BusId{0};
+        std::vector<BusId> last_bus(stop_names_.size(), NO_BUS);
+        auto for_each_stop_bus = [&](auto callback) {
+            std::fill(last_bus.begin(), last_bus.end(), NO_BUS);
+            for (BusId bus : sorted_buses) {
+                for (StopId stop : GetBusRoute(bus)) {
+                    if (last_bus[stop] != bus) {
+                        last_bus[stop] = bus;
+                        callback(stop, bus);
+                    }
+                }
+            }
+        };
+
+        stop_bus_offsets_.assign(stop_names_.size() + 1, 0);
+        for_each_stop_bus([this](StopId stop, BusId) {
+            ++stop_bus_offsets_[stop + 1];
+        });
+        std::partial_sum(stop_bus_offsets_.begin(), stop_bus_offsets_.end(), stop_bus_offsets_.begin());
+
+        stop_buses_.resize(stop_bus_offsets_.back());
+        std::vector<uint32_t> positions(stop_bus_offsets_.begin(), stop_bus_offsets_.end() - 1);
+        for_each_stop_bus([this, &positions](StopId stop, BusId bus) {
+            stop_buses_[positions[stop]++] = bus;
+        });
+
+        //Хэш-функции строим по словарям: если название добавлялось дважды, действует последнее добавление
+        auto build_hash = [](PerfectHash& hash, const auto& name_to_id) {
+            std::vector<std::string_view> names;
+            std::vector<uint32_t> ids;
+            names.reserve(name_to_id.size());
+            ids.reserve(name_to_id.size());
+            for (const auto& [name, id] : name_to_id) {
+                names.push_back(name);
+                ids.push_back(id);
+            }
+            hash.Build(names, ids);
+        };
+        build_hash(stop_hash_, name_to_stop_);
+        build_hash(bus_hash_, name_to_bus_);
+
+        //В индекс попадают только остановки, доступные по названию
+        std::vector<StopId> indexed_stops;
+        indexed_stops.reserve(name_to_stop_.size());
+        for (const auto& [name, stop] : name_to_stop_) {
+            indexed_stops.push_back(stop);
         }
+        stop_index_.Build(indexed_stops, stop_latitudes_, stop_longitudes_);
 
-        return distance;
+        is_finalized_ = true;
     }
 
-    int TransportCatalogue::GetRouteRealDistance(const Bus& bus) const {
-        int distance = 0;
+    int TransportCatalogue::GetRealLength(StopId first_stop, StopId second_stop) const {
+        const int* length = stops_to_length_.Find(first_stop, second_stop);
+        return length != nullptr ? *length : 0;
+    }
 
-        for (size_t i = 1; i < bus.route.size(); ++i) {
-            distance += GetRealLength(bus.route[i - 1], bus.route[i]);
+    void TransportCatalogue::UpdateRouteStats(BusId bus) {
+        const RouteRange route = GetBusRoute(bus);
+        const size_t offset = route_offsets_[bus];
+        if (route.empty()) {
+            route_infos_[bus] = {};
+            return;
         }
 
-        if (bus.type == RouteType::ONE_WAY) {
-            for (size_t i = 1; i < bus.route.size(); ++i) {
-                distance += GetRealLength(bus.route[i], bus.route[i - 1]);
-            }
+        //Перегоны считаются одним пакетом прямо в route_geo_, затем складываются в префиксные суммы
+        std::vector<geo::SphericalCoordinates> points(route.size());
+        std::transform(route.begin(), route.end(), points.begin(), [this](StopId stop) {
+            return stop_spherical_[stop];
+        });
+        geo::ComputeDistances(points.data(), points.data() + 1, route_geo_.data() + offset + 1, route.size() - 1);
+
+        route_real_forward_[offset] = 0;
+        route_real_backward_[offset] = 0;
+        route_geo_[offset] = 0.0;
+        for (size_t i = 1; i < route.size(); ++i) {
+            route_real_forward_[offset + i] = route_real_forward_[offset + i - 1] + GetRealLength(route[i - 1], route[i]);
+            route_real_backward_[offset + i] = route_real_backward_[offset + i - 1] + GetRealLength(route[i], route[i - 1]);
+            route_geo_[offset + i] += route_geo_[offset + i - 1];
+        }
+
+        const size_t last = offset + route.size() - 1;
+        size_t total_stops = route.size();
+        int real_length = route_real_forward_[last];
+        double geo_length = route_geo_[last];
+        if (bus_types_[bus] == RouteType::ONE_WAY) {
+            total_stops = (total_stops * 2) - 1;
+            real_length += route_real_backward_[last];
+            geo_length *= 2;
         }
 
-        return distance;
+        std::vector<StopId> uniq_stops(route.begin(), route.end());
+        std::sort(uniq_stops.begin(), uniq_stops.end());
+        uniq_stops.erase(std::unique(uniq_stops.begin(), uniq_stops.end()), uniq_stops.end());
+
+        route_infos_[bus] = {
+                total_stops,
+                uniq_stops.size(),
+                real_length,
+                real_length / geo_length
+        };
     }
 
     void TransportCatalogue::AddDistance(std::string_view stop_name, std::string_view destination_name, int distace) {
-        Stop* stop = name_to_stop_.at(stop_name);
-        Stop* destination = name_to_stop_.at(destination_name);
+        StopId stop = name_to_stop_.at(stop_name);
+        StopId destination = name_to_stop_.at(destination_name);
 
-        stops_to_length_[std::pair<Stop*, Stop*>{stop, destination}] = distace;
+        stops_to_length_.Set(stop, destination, distace);
 
         //Добавляем обратный путь, если ещё не добавлен
-        std::pair<const Stop*, const Stop*> destination_to_stop = {destination, stop};
-        if (stops_to_length_.count(destination_to_stop) == 0) {
-            stops_to_length_[destination_to_stop] = distace;
+        stops_to_length_.Insert(destination, stop, distace);
+
+        MarkStopDirty(stop);
+        MarkStopDirty(destination);
+    }
+
+    void TransportCatalogue::MarkStopDirty(StopId stop) {
+        //Обычно расстояния добавляются раньше автобусов, тогда пересчитывать нечего
+        if (bus_names_.empty()) {
+            return;
+        }
+        if (dirty_stops_.size() <= stop) {
+            dirty_stops_.resize(stop_names_.size(), false);
         }
+        dirty_stops_[stop] = true;
+        is_finalized_ = false;
     }
 
     bool TransportCatalogue::IsBusExists(std::string_view bus_name) const noexcept {
-        return name_to_bus_.count(bus_name) > 0;
+        return FindBus(bus_name).has_value();
     }
 
     bool TransportCatalogue::IsStopExists(std::string_view stop_name) const noexcept {
-        return name_to_stop_.count(stop_name) > 0;
+        return FindStop(stop_name).has_value();
+    }
+
+    std::optional<StopId> TransportCatalogue::FindStop(std::string_view stop_name) const {
+        if (is_finalized_) {
+            return stop_hash_.Find(stop_name);
+        }
+        auto it = name_to_stop_.find(stop_name);
+        if (it == name_to_stop_.end()) return std::nullopt;
+        return it->second;
+    }
+
+    std::optional<BusId> TransportCatalogue::FindBus(std::string_view bus_name) const {
+        if (is_finalized_) {
+            return bus_hash_.Find(bus_name);
+        }
+        auto it = name_to_bus_.find(bus_name);
+        if (it == name_to_bus_.end()) return std::nullopt;
+        return it->second;
+    }
+
+    const DistanceTable& TransportCatalogue::GetDistances() const {
+        return stops_to_length_;
+    }
+
+    size_t TransportCatalogue::GetStopCount() const noexcept {
+        return stop_names_.size();
+    }
+
+    std::string_view TransportCatalogue::GetStopName(StopId stop) const {
+        return stop_names_[stop];
+    }
+
+    geo::Coordinates TransportCatalogue::GetStopCoords(StopId stop) const {
+        return {stop_latitudes_[stop], stop_longitudes_[stop]};
+    }
+
+    size_t TransportCatalogue::GetBusCount() const noexcept {
+        return bus_names_.size();
+    }
+
+    std::string_view TransportCatalogue::GetBusName(BusId bus) const {
+        return bus_names_[bus];
     }
 
-    const std::deque<Bus>& TransportCatalogue::GetBuses() const {
-        return buses_source_;
+    RouteType TransportCatalogue::GetBusType(BusId bus) const {
+        return bus_types_[bus];
     }
 
-    const Stop* TransportCatalogue::GetStop(std::string_view stop_name) const {
-        if (name_to_stop_.count(stop_name) == 0) return nullptr;
-        return name_to_stop_.at(stop_name);
+    RouteRange TransportCatalogue::GetBusRoute(BusId bus) const {
+        return {route_stops_.begin() + route_offsets_[bus], route_stops_.begin() + route_offsets_[bus + 1]};
     }
 
 } //namespace transport_catalogue
@@ -1,58 +1,124 @@
 #pragma once
 
 #include <string>
-#include <deque>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
-#include <set>
-#include <utility>
+#include <optional>
 
 #include "geo/geo.h"
 #include "domain.h"
+#include "distance_table.h"
+#include "string_pool.h"
+#include "perfect_hash.h"
+#include "spatial_index.h"
+#include "router/ranges.h"
 
 namespace transport_catalogue {
     using namespace domain;
 
-    namespace detail {
-
-        struct StopsHasher {
-            size_t operator()(const std::pair<const Stop*, const Stop*>& stops) const;
-        private:
-            std::hash<const void*> ptr_hasher_;
-        };
-
-    } //namespace detail
+    using RouteRange = ranges::Range<std::vector<StopId>::const_iterator>;
+    using BusRange = ranges::Range<std::vector<BusId>::const_iterator>;
 
+    /*
+     * Остановки и автобусы хранятся по столбцам и адресуются плотными номерами StopId и BusId.
+     * Поиск по названию остаётся только на границе интерфейса
+     */
     class TransportCatalogue {
     public:
         TransportCatalogue() = default;
 
-        void AddStop(std::string_view name, double latitude, double longitude);
+        StopId AddStop(std::string_view name, double latitude, double longitude);
         void AddDistance(std::string_view stop_name, std::string_view destination_name, int distace);
-        void AddBus(std::string_view name, const std::vector<std::string_view>& raw_route, RouteType type);
+        BusId AddBus(std::string_view name, const std::vector<std::string_view>& raw_route, RouteType type);
+        // Добавляет сразу все остановки, затем расстояния, затем автобусы. Результат тот же, что у
+        // поочерёдных AddStop, AddDistance и AddBus, но место выделяется заранее, а маршруты
+        // разбираются и считаются параллельно
+        void AddBulk(const std::vector<StopDescription>& stops, const std::vector<DistanceDescription>& distances,
+                     const std::vector<BusDescription>& buses);
 
         bool IsBusExists(std::string_view bus_name) const noexcept;
         bool IsStopExists(std::string_view stop_name) const noexcept;
 
+        std::optional<StopId> FindStop(std::string_view stop_name) const;
+        std::optional<BusId> FindBus(std::string_view bus_name) const;
+
+        // Если расстояния добавлялись после автобусов, их статистика обновится только в Finalize
         RouteInfo GetRouteInfo(std::string_view bus_name) const;
-        const std::set<std::string_view>& GetStopBuses(std::string_view stop_name) const;
-        const std::deque<Bus>& GetBuses() const;
-        int GetRealLength(const Stop* first_stop, const Stop* second_stop) const;
-        const Stop* GetStop(std::string_view stop_name) const;
+        const RouteInfo& GetRouteInfo(BusId bus) const;
+        // Дорожное расстояние по маршруту bus от остановки с индексом from до остановки с индексом to.
+        // Если from > to, едем по маршруту в обратную сторону
+        int GetRouteRealLength(BusId bus, size_t from, size_t to) const;
+        // Автобусы, проходящие через остановку, отсортированные по названию. Требует вызова Finalize
+        BusRange GetStopBuses(StopId stop) const;
+        int GetRealLength(StopId first_stop, StopId second_stop) const;
+        const DistanceTable& GetDistances() const;
+
+        size_t GetStopCount() const noexcept;
+        std::string_view GetStopName(StopId stop) const;
+        geo::Coordinates GetStopCoords(StopId stop) const;
+        // Не более count остановок, ближайших к point, по возрастанию расстояния. Требует вызова Finalize
+        std::vector<StopId> FindNearestStops(geo::Coordinates point, size_t count) const;
+        // Остановки в прямоугольнике координат от min до max включительно. Требует вызова Finalize
+        std::vector<StopId> FindStopsInArea(geo::Coordinates min, geo::Coordinates max) const;
+
+        size_t GetBusCount() const noexcept;
+        std::string_view GetBusName(BusId bus) const;
+        RouteType GetBusType(BusId bus) const;
+        RouteRange GetBusRoute(BusId bus) const;
+
+        // Пересчитывает статистику маршрутов, затронутых новыми расстояниями, собирает списки автобусов
+        // остановок, совершенные хэш-функции названий и пространственный индекс.
+        // Вызывается после загрузки и после каждого добавления остановок, расстояний и автобусов
+        void Finalize();
 
         TransportCatalogue(const TransportCatalogue&) = delete;
         TransportCatalogue& operator=(const TransportCatalogue&) = delete;
 
     private:
-        std::deque<Stop> stops_source_;
-        std::deque<Bus> buses_source_;
-        std::unordered_map<std::string_view, Stop*> name_to_stop_;
-        std::unordered_map<std::string_view, Bus*> name_to_bus_;
-        std::unordered_map<Stop*, std::set<std::string_view>> stop_to_buses_;
-        std::unordered_map<std::pair<const Stop*, const Stop*>, int, detail::StopsHasher> stops_to_length_;
-
-        double GetRouteGeoDistance(const Bus& bus) const;
-        int GetRouteRealDistance(const Bus& bus) const;
+        // Все названия лежат в одном хранилище, одинаковые названия остановки и автобуса - один раз
+        StringPool names_;
+
+        // Столбцы остановок
+        std::vector<std::string_view> stop_names_;
+        std::vector<double> stop_latitudes_;
+        std::vector<double> stop_longitudes_;
+        // Синус и косинус широты считаются один раз при добавлении остановки
+        std::vector<geo::SphericalCoordinates> stop_spherical_;
+
+        // Столбцы автобусов. Маршрут автобуса bus - route_stops_[route_offsets_[bus], route_offsets_[bus + 1])
+        std::vector<std::string_view> bus_names_;
+        std::vector<RouteType> bus_types_;
+        std::vector<size_t> route_offsets_ = {0};
+        std::vector<StopId> route_stops_;
+
+        // Префиксные суммы расстояний вдоль маршрутов, индексы совпадают с route_stops_.
+        // В обратную сторону считаются только дорожные расстояния, географические симметричны
+        std::vector<int> route_real_forward_;
+        std::vector<int> route_real_backward_;
+        std::vector<double> route_geo_;
+        std::vector<RouteInfo> route_infos_;
+
+        // Словари нужны, пока каталог заполняется. После Finalize поиск идёт по совершенным хэш-функциям
+        std::unordered_map<std::string_view, StopId> name_to_stop_;
+        std::unordered_map<std::string_view, BusId> name_to_bus_;
+        PerfectHash stop_hash_;
+        PerfectHash bus_hash_;
+        // Автобусы остановки stop - stop_buses_[stop_bus_offsets_[stop], stop_bus_offsets_[stop + 1])
+        std::vector<uint32_t> stop_bus_offsets_;
+        std::vector<BusId> stop_buses_;
+        SpatialIndex stop_index_;
+        bool is_finalized_ = true;
+        DistanceTable stops_to_length_;
+        // Остановки, расстояния до которых менялись после добавления автобусов. Маршруты через них
+        // пересчитываются в Finalize
+        std::vector<bool> dirty_stops_;
+
+        // Возвращает view на название в хранилище, копируя его туда только при первой встрече
+        std::string_view InternName(std::string_view name);
+        // Пересчитывает префиксные суммы и статистику маршрута
+        void UpdateRouteStats(BusId bus);
+        void MarkStopDirty(StopId stop);
 
     };
 